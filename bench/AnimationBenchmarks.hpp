@@ -0,0 +1,126 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AnimatedSprite.hpp"
+#include "Benchmark.hpp"
+#include "GlobalDefines.hpp"
+#include "KeyFrameAnimator.hpp"
+
+namespace AnimationBenchmarks
+{
+using KeyType = AnimatedSprite::KeyType;
+
+// The player's run cycle, four keys on one timeline
+KeyFrameAnimator<KeyType> createRunAnimation()
+{
+	KeyFrameAnimator<KeyType> toRet(270000);
+	toRet.addKeyToKeyFrameTimeline(KeyType::RECT_X, 0, 16.f);
+	toRet.addKeyToKeyFrameTimeline(KeyType::RECT_X, 90000, 32.f);
+	toRet.addKeyToKeyFrameTimeline(KeyType::RECT_X, 180000, 48.f);
+	return toRet;
+}
+
+// Several continuous timelines with many keys each, so every tick interpolates
+KeyFrameAnimator<KeyType> createContinuousAnimation(int timelines, int keysPerTimeline)
+{
+	const int duration = 1000000;
+
+	KeyFrameAnimator<KeyType> toRet(duration);
+	for (int timeline = 0; timeline < timelines; ++timeline)
+	{
+		for (int key = 0; key <= keysPerTimeline; ++key)
+			toRet.addKeyToKeyFrameTimeline((KeyType)timeline, key * duration / keysPerTimeline, (float)key, true);
+	}
+	return toRet;
+}
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("KeyFrameAnimator"))
+		return;
+
+	bench.printHeader("KeyFrameAnimator");
+
+	std::vector<std::pair<KeyType, float>> values;
+
+	// Sums up whatever the animator produces so the visitor can't be optimized away
+	float sum    = 0.f;
+	auto visitor = [&sum](KeyType, float value) { sum += value; };
+
+	auto runAnimation = createRunAnimation();
+	bench.run("tick, run cycle", [&]() { doNotOptimize(runAnimation.tick(D_TICK_DURATION)); });
+	bench.run("tick buffer, run cycle",
+			  [&]()
+			  {
+				  runAnimation.tick(D_TICK_DURATION, values);
+				  doNotOptimize(values.data());
+			  });
+	bench.run("tick visitor, run cycle",
+			  [&]()
+			  {
+				  runAnimation.tick(D_TICK_DURATION, visitor);
+				  doNotOptimize(sum);
+			  });
+
+	// Everything a sprite does per tick, animating and applying the values to its texture rect
+	AnimatedSprite sprite;
+	sprite.addAnimation("Run", createRunAnimation());
+	bench.run("AnimatedSprite::tick, run cycle",
+			  [&]()
+			  {
+				  sprite.tick(D_TICK_DURATION);
+				  doNotOptimize(sprite.getSprite());
+			  });
+
+	// What a level does for every coin it places, with as many animations as the player has
+	AnimatedSprite animatedSprite;
+	for (const char* name : {"Stand", "Run", "Jump", "Fall", "Turn", "Push"})
+		animatedSprite.addAnimation(name, createRunAnimation());
+	bench.run("copy AnimatedSprite, 6 animations",
+			  [&]()
+			  {
+				  AnimatedSprite copy(animatedSprite);
+				  doNotOptimize(copy.getSprite());
+			  });
+
+	// What the player does every tick, switching to the animation it's already playing
+	const AnimatedSprite::AnimationId push = animatedSprite.findAnimation("Push");
+	animatedSprite.setAnimation(push);
+	bench.run("setAnimation by name, 6 animations",
+			  [&]()
+			  {
+				  animatedSprite.setAnimation("Push", animatedSprite.getCurrentAnimationName() != "Push");
+				  doNotOptimize(animatedSprite);
+			  });
+	bench.run("setAnimation by id, 6 animations",
+			  [&]()
+			  {
+				  animatedSprite.setAnimation(push, animatedSprite.getCurrentAnimation() != push);
+				  doNotOptimize(animatedSprite);
+			  });
+
+	for (int keys : {4, 64})
+	{
+		auto animation          = createContinuousAnimation(4, keys);
+		const std::string label = ", 4 continuous timelines, " + std::to_string(keys) + " keys each";
+
+		bench.run("tick" + label, [&]() { doNotOptimize(animation.tick(D_TICK_DURATION)); });
+		bench.run("tick buffer" + label,
+				  [&]()
+				  {
+					  animation.tick(D_TICK_DURATION, values);
+					  doNotOptimize(values.data());
+				  });
+		bench.run("tick visitor" + label,
+				  [&]()
+				  {
+					  animation.tick(D_TICK_DURATION, visitor);
+					  doNotOptimize(sum);
+				  });
+	}
+}
+}  // namespace AnimationBenchmarks
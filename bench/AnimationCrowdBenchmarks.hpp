@@ -0,0 +1,112 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+#include "AnimatedSprite.hpp"
+#include "AnimationCrowd.hpp"
+#include "Benchmark.hpp"
+#include "GlobalDefines.hpp"
+#include "KeyFrameAnimator.hpp"
+#include "SpriteBatch.hpp"
+
+namespace AnimationCrowdBenchmarks
+{
+using KeyType = AnimatedSprite::KeyType;
+
+// Same as the coins of the game, a four frame spin on one timeline
+AnimatedSprite createCoinSprite(const sf::Texture& texture)
+{
+	AnimatedSprite toRet;
+	toRet.setTexture(texture);
+	toRet.setTextureRect({0, 0, 16, 16});
+
+	KeyFrameAnimator<KeyType> anim(500000);
+	anim.addKeyToKeyFrameTimeline(KeyType::RECT_X, 0, 0.f);
+	anim.addKeyToKeyFrameTimeline(KeyType::RECT_X, 125000, 16.f);
+	anim.addKeyToKeyFrameTimeline(KeyType::RECT_X, 250000, 32.f);
+	anim.addKeyToKeyFrameTimeline(KeyType::RECT_X, 375000, 48.f);
+	toRet.addAnimation("Spin", anim);
+
+	return toRet;
+}
+
+// Bobbing up and down while pulsing, two continuous timelines so every tick interpolates
+AnimatedSprite createPulsingSprite(const sf::Texture& texture)
+{
+	AnimatedSprite toRet = createCoinSprite(texture);
+
+	KeyFrameAnimator<KeyType> anim(500000);
+	for (KeyType key : {KeyType::SCALE_X, KeyType::SCALE_Y})
+	{
+		anim.addKeyToKeyFrameTimeline(key, 0, 1.f, true);
+		anim.addKeyToKeyFrameTimeline(key, 250000, 1.5f, true);
+		anim.addKeyToKeyFrameTimeline(key, 500000, 1.f, true);
+	}
+	toRet.addAnimation("Pulse", anim);
+	toRet.setAnimation("Pulse");
+
+	return toRet;
+}
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("AnimationCrowd"))
+		return;
+
+	bench.printHeader("AnimationCrowd");
+
+	sf::Texture texture;
+	SpriteBatch batch;
+
+	for (bool pulsing : {false, true})
+	{
+		const AnimatedSprite templateSprite = pulsing ? createPulsingSprite(texture) : createCoinSprite(texture);
+
+		for (int count : {100, 10000})
+		{
+			std::vector<AnimatedSprite> sprites;
+			AnimationCrowd crowd;
+			crowd.setSprite(templateSprite);
+
+			for (int i = 0; i < count; ++i)
+			{
+				const sf::Vector2f position((float)(i % 1000) * 16.f, (float)(i / 1000) * 16.f);
+
+				sprites.push_back(templateSprite);
+				sprites.back().setPosition(position);
+				crowd.spawn(position);
+			}
+
+			const std::string suffix = pulsing ? ", " + std::to_string(count) + " pulsing sprites"
+											   : ", " + std::to_string(count) + " coins";
+
+			// What the game did before, tick every sprite and add it to the batch
+			bench.run("AnimatedSprite tick and add" + suffix,
+					  [&]()
+					  {
+						  batch.clear();
+						  for (auto& sprite : sprites)
+						  {
+							  sprite.tick(D_TICK_DURATION);
+							  batch.add(sprite.getSprite());
+						  }
+						  doNotOptimize(batch);
+					  });
+
+			auto crowdTick = [&]()
+			{
+				batch.clear();
+				crowd.tick(D_TICK_DURATION);
+				crowd.appendQuads(batch);
+				doNotOptimize(batch);
+			};
+
+			bench.run("tick and appendQuads" + suffix, crowdTick);
+			bench.runThreaded("tick and appendQuads" + suffix, crowdTick);
+		}
+	}
+}
+}  // namespace AnimationCrowdBenchmarks
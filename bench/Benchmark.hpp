@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AllocationTracker.hpp"
+#include "JobSystem.hpp"
+
+// Tiny benchmarking harness, runs a function in growing batches until a batch takes long enough to be
+// measured reliably, then times a few more batches of that size and reports the median time of a single
+// call, along with how many heap allocations a call makes (when AllocationTracker is enabled).
+class Benchmark
+{
+public:
+	static Benchmark& Get()
+	{
+		static Benchmark INSTANCE;
+		return INSTANCE;
+	}
+	Benchmark(Benchmark&&)                 = delete;
+	Benchmark(const Benchmark&)            = delete;
+	Benchmark& operator=(Benchmark&&)      = delete;
+	Benchmark& operator=(const Benchmark&) = delete;
+
+	void setMinBatchTime(std::chrono::nanoseconds val) { minBatchTime = val; }
+	void setRepetitions(int val) { repetitions = std::max(val, 1); }
+
+	// Only suites whose name contains filter are run, see shouldRun()
+	void setFilter(const std::string& val) { filter = val; }
+	bool shouldRun(const std::string& suiteName) const { return suiteName.find(filter) != std::string::npos; }
+
+	void printHeader(const std::string& suiteName)
+	{
+		std::cout << "\n== " << suiteName << " ==\n" << std::left << std::setw(nameWidth) << "benchmark" << std::right
+				  << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op" << std::setw(14) << "iterations"
+				  << std::endl;
+	}
+
+	template <typename Function>
+	double run(const std::string& name, Function&& function)
+	{
+		return _run(name, function, false);
+	}
+
+	// Runs function again with a job system worker per extra core and the thread count appended to name. Does
+	// nothing on a single core. Allocations are only counted on the calling thread, not in jobs on the workers,
+	// so they are marked with a *.
+	template <typename Function>
+	void runThreaded(const std::string& name, Function&& function)
+	{
+		const unsigned workers = JobSystem::getDefaultWorkerCount();
+		if (workers == 0)
+			return;
+
+		JobSystem::Get().start(workers);
+		_run(name + ", " + std::to_string(workers + 1) + " threads", function, true);
+		JobSystem::Get().stop();
+	}
+
+private:
+	Benchmark() = default;
+
+	std::chrono::nanoseconds minBatchTime = std::chrono::milliseconds(50);
+	int repetitions                       = 5;
+	const uint64_t maxIterations          = 1ull << 32;
+	const int nameWidth                   = 52;
+
+	std::string filter;
+	std::vector<double> batchTimes;
+
+	template <typename Function>
+	double _run(const std::string& name, Function&& function, bool mainThreadAllocationsOnly)
+	{
+		// Warm up caches and lazily grown buffers
+		function();
+
+		uint64_t iterations = 1;
+		std::chrono::nanoseconds elapsed(0);
+
+		while (true)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < iterations; ++i)
+				function();
+			elapsed = std::chrono::steady_clock::now() - start;
+
+			if (elapsed >= minBatchTime || iterations >= maxIterations)
+				break;
+
+			iterations *= 2;
+		}
+
+		// The median of a few batches is much steadier between runs than a single batch
+		batchTimes.clear();
+		const auto allocationsBefore = AllocationTracker::getCounts().allocations;
+		for (int repetition = 0; repetition < repetitions; ++repetition)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < iterations; ++i)
+				function();
+			batchTimes.push_back((double)(std::chrono::steady_clock::now() - start).count() / (double)iterations);
+		}
+		const auto allocations = AllocationTracker::getCounts().allocations - allocationsBefore;
+
+		std::nth_element(batchTimes.begin(), batchTimes.begin() + batchTimes.size() / 2, batchTimes.end());
+		const double nsPerOp = batchTimes[batchTimes.size() / 2];
+
+		std::cout << std::left << std::setw(nameWidth) << name << std::right << std::setw(14) << std::fixed
+				  << std::setprecision(1) << nsPerOp << std::setw(14);
+		if (AllocationTracker::ENABLED)
+		{
+			std::ostringstream allocationsPerOp;
+			allocationsPerOp << std::fixed << std::setprecision(2)
+							 << (double)allocations / (double)(iterations * repetitions)
+							 << (mainThreadAllocationsOnly ? "*" : "");
+			std::cout << allocationsPerOp.str();
+		}
+		else
+			std::cout << '-';
+		std::cout << std::setw(14) << iterations << std::endl;
+
+		return nsPerOp;
+	}
+};
+
+// Keeps the compiler from optimizing away a value that is never used
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+	const volatile T* volatile sink = &value;
+	(void)sink;
+}
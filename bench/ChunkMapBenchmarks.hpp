@@ -0,0 +1,99 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "ChunkMap.hpp"
+#include "CollisionBenchmarks.hpp"
+#include "StaticTile.hpp"
+
+namespace ChunkMapBenchmarks
+{
+using CollisionBenchmarks::chunkTiles;
+using CollisionBenchmarks::tileSize;
+
+const sf::Vector2f chunkSize(chunkTiles.x * tileSize.x, chunkTiles.y * tileSize.y);
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("ChunkMap"))
+		return;
+
+	bench.printHeader("ChunkMap");
+
+	// Inserting a whole floor, the way Level fills its collision bodies
+	for (int width : {48, 1000})
+	{
+		std::vector<std::shared_ptr<StaticTile>> tiles;
+		for (int x = 0; x < width; ++x)
+			tiles.push_back(std::make_shared<StaticTile>(sf::Vector2f(x * tileSize.x, 17 * tileSize.y), tileSize, 1));
+
+		bench.run("insertAuto, " + std::to_string(width) + " tiles",
+				  [&]()
+				  {
+					  ChunkMap<StaticTile> map(chunkSize);
+					  for (const auto& tile : tiles)
+						  map.insertAuto(tile->getRect(), tile);
+					  doNotOptimize(map);
+				  });
+
+		bench.run("insertAuto bounded, " + std::to_string(width) + " tiles",
+				  [&]()
+				  {
+					  ChunkMap<StaticTile> map(chunkSize);
+					  map.setBounds({0, 0}, {(width - 1) / chunkTiles.x, 17 / chunkTiles.y});
+					  for (const auto& tile : tiles)
+						  map.insertAuto(tile->getRect(), tile);
+					  doNotOptimize(map);
+				  });
+	}
+
+	for (int width : {48, 5000})
+	{
+		auto level = CollisionBenchmarks::createLevel(width);
+
+		// A player sized box and a screen sized one in the middle of the level
+		const sf::FloatRect playerRect(width * tileSize.x / 2.f, 15 * tileSize.y, 14.f, 14.f);
+		const sf::FloatRect screenRect(width * tileSize.x / 2.f - 128.f, 0.f, 256.f, 192.f);
+
+		const auto playerChunks = level.findUnderlyingChunks(playerRect);
+		const auto screenChunks = level.findUnderlyingChunks(screenRect);
+
+		std::vector<StaticTile*> buffer;
+
+		const std::string suffix = ", " + std::to_string(width) + " tiles wide";
+
+		bench.run("findUnderlyingChunks, player" + suffix,
+				  [&]() { doNotOptimize(level.findUnderlyingChunks(playerRect)); });
+		bench.run("findUnderlyingChunks, screen" + suffix,
+				  [&]() { doNotOptimize(level.findUnderlyingChunks(screenRect)); });
+		bench.run("findUnderlyingChunkRange, screen" + suffix,
+				  [&]() { doNotOptimize(level.findUnderlyingChunkRange(screenRect)); });
+
+		bench.run("gatherFromChunks set, player" + suffix,
+				  [&]() { doNotOptimize(level.gatherFromChunks(playerChunks)); });
+		bench.run("gatherFromChunks set, screen" + suffix,
+				  [&]() { doNotOptimize(level.gatherFromChunks(screenChunks)); });
+		bench.run("gatherFromChunks buffer, screen" + suffix,
+				  [&]()
+				  {
+					  level.gatherFromChunks(screenChunks, buffer);
+					  doNotOptimize(buffer.data());
+				  });
+		bench.run("query, screen" + suffix,
+				  [&]()
+				  {
+					  level.query(screenRect, buffer);
+					  doNotOptimize(buffer.data());
+				  });
+
+		if (width <= 48)
+			bench.run("gatherFromChunks set, all chunks" + suffix,
+					  [&]() { doNotOptimize(level.gatherFromChunks()); });
+	}
+}
+}  // namespace ChunkMapBenchmarks
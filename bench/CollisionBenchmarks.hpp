@@ -0,0 +1,134 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "ChunkMap.hpp"
+#include "ColliderEntity.hpp"
+#include "CollisionAlgorithms.hpp"
+#include "CollisionGrid.hpp"
+#include "StaticTile.hpp"
+
+namespace CollisionBenchmarks
+{
+// Same layout Level builds: 16x16 tiles in 8x6 tile chunks
+const sf::Vector2f tileSize(16.f, 16.f);
+const sf::Vector2i chunkTiles(8, 6);
+
+// A flat level widthInTiles wide and 18 tiles high, with a two tile thick floor and a column every 12 tiles
+ChunkMap<StaticTile> createLevel(int widthInTiles, int heightInTiles = 18, CollisionGrid* outSolidTiles = nullptr)
+{
+	ChunkMap<StaticTile> toRet(sf::Vector2f(chunkTiles.x * tileSize.x, chunkTiles.y * tileSize.y));
+	toRet.setBounds({0, 0}, {(widthInTiles - 1) / chunkTiles.x, (heightInTiles - 1) / chunkTiles.y});
+
+	if (outSolidTiles)
+		outSolidTiles->create({0, 0}, {widthInTiles, heightInTiles}, tileSize);
+
+	auto addTile = [&toRet, outSolidTiles](int x, int y)
+	{
+		toRet.insertNewValue(sf::Vector2i(x / chunkTiles.x, y / chunkTiles.y),
+							 StaticTile(sf::Vector2f(x * tileSize.x, y * tileSize.y), tileSize, 1));
+		if (outSolidTiles)
+			outSolidTiles->set(x, y);
+	};
+
+	for (int x = 0; x < widthInTiles; ++x)
+	{
+		addTile(x, heightInTiles - 1);
+		addTile(x, heightInTiles - 2);
+
+		if (x % 12 == 11)
+			addTile(x, heightInTiles - 3);
+	}
+
+	return toRet;
+}
+
+// widthInTiles by 18 tiles where roughly density (0 to 1) of all tiles are solid, scattered the same way
+// every run
+ChunkMap<StaticTile> createScatteredLevel(int widthInTiles, float density, CollisionGrid* outSolidTiles = nullptr)
+{
+	const int heightInTiles = 18;
+
+	ChunkMap<StaticTile> toRet(sf::Vector2f(chunkTiles.x * tileSize.x, chunkTiles.y * tileSize.y));
+	toRet.setBounds({0, 0}, {(widthInTiles - 1) / chunkTiles.x, (heightInTiles - 1) / chunkTiles.y});
+
+	if (outSolidTiles)
+		outSolidTiles->create({0, 0}, {widthInTiles, heightInTiles}, tileSize);
+
+	uint32_t random = 12345;
+	for (int y = 0; y < heightInTiles; ++y)
+	{
+		for (int x = 0; x < widthInTiles; ++x)
+		{
+			random = random * 1664525u + 1013904223u;
+			if ((float)(random >> 8) / (float)(1u << 24) >= density)
+				continue;
+
+			toRet.insertNewValue(sf::Vector2i(x / chunkTiles.x, y / chunkTiles.y),
+								 StaticTile(sf::Vector2f(x * tileSize.x, y * tileSize.y), tileSize, 1));
+			if (outSolidTiles)
+				outSolidTiles->set(x, y);
+		}
+	}
+
+	return toRet;
+}
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("AABBWithStaticBodiesCollisionCheck"))
+		return;
+
+	bench.printHeader("AABBWithStaticBodiesCollisionCheck");
+
+	for (int width : {48, 500, 5000, 50000})
+	{
+		CollisionGrid solidTiles;
+		auto level = createLevel(width, 18, &solidTiles);
+
+		// Standing on the floor in the middle of the level, sunk into it a little like after a move
+		ColliderEntity entity(sf::Vector2f(width * tileSize.x / 2.f + 5.f, 16 * tileSize.y - 6.f),
+							  sf::Vector2f(14.f, 14.f), sf::Vector2f(-7.f, -7.f));
+		entity.setMoveVector({1.2f, 0.5f});
+
+		auto& collision = CollisionAlgorithms::Get();
+
+		bench.run("broad phase, " + std::to_string(width) + " tiles wide",
+				  [&]() { doNotOptimize(collision.AABBWithStaticBodiesCollisionCheck(level, entity)); });
+
+		bench.run("bit grid, " + std::to_string(width) + " tiles wide",
+				  [&]() { doNotOptimize(collision.AABBWithCollisionGridCheck(solidTiles, entity)); });
+
+		// Every tile, what passing no chunks used to cost
+		if (width <= 5000)
+			bench.run("all chunks, " + std::to_string(width) + " tiles wide",
+					  [&]() { doNotOptimize(collision.AABBWithStaticBodiesCollisionCheck(level, entity, {})); });
+	}
+
+	// More solid tiles around the entity means more narrow phase work per check
+	for (float density : {0.1f, 0.25f, 0.5f, 1.f})
+	{
+		CollisionGrid solidTiles;
+		auto level = createScatteredLevel(500, density, &solidTiles);
+
+		ColliderEntity entity(sf::Vector2f(250 * tileSize.x + 5.f, 9 * tileSize.y + 3.f), sf::Vector2f(14.f, 14.f),
+							  sf::Vector2f(-7.f, -7.f));
+		entity.setMoveVector({1.2f, 0.5f});
+
+		auto& collision = CollisionAlgorithms::Get();
+
+		const std::string suffix = ", " + std::to_string((int)(density * 100.f)) + "% tiles solid";
+
+		bench.run("broad phase" + suffix,
+				  [&]() { doNotOptimize(collision.AABBWithStaticBodiesCollisionCheck(level, entity)); });
+
+		bench.run("bit grid" + suffix,
+				  [&]() { doNotOptimize(collision.AABBWithCollisionGridCheck(solidTiles, entity)); });
+	}
+}
+}  // namespace CollisionBenchmarks
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "CollisionBenchmarks.hpp"
+#include "CollisionGrid.hpp"
+#include "EnemyStore.hpp"
+#include "GlobalDefines.hpp"
+
+namespace EnemyBenchmarks
+{
+using CollisionBenchmarks::tileSize;
+
+// count enemies spread evenly over the floor of a flat level, they walk back and forth between its columns
+EnemyStore createEnemies(const CollisionGrid& solidTiles, int count)
+{
+	EnemyStore toRet;
+	toRet.setAnimation({0, 0}, {16, 16}, 7, 700000);
+	toRet.spawnAcross(solidTiles, (size_t)count);
+
+	return toRet;
+}
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("EnemyStore"))
+		return;
+
+	bench.printHeader("EnemyStore");
+
+	CollisionGrid solidTiles;
+	CollisionBenchmarks::createLevel(5000, 18, &solidTiles);
+
+	sf::VertexArray vertices(sf::Quads);
+
+	for (int count : {100, 10000, 100000})
+	{
+		auto enemies = createEnemies(solidTiles, count);
+
+		// Let them land first
+		for (int i = 0; i < 4 * D_TICK_RATE; ++i)
+			enemies.process(D_TICK_DURATION, solidTiles);
+
+		const std::string suffix = ", " + std::to_string(count) + " enemies";
+
+		auto process = [&]()
+		{
+			enemies.savePreviousPositions();
+			enemies.process(D_TICK_DURATION, solidTiles);
+			doNotOptimize(enemies);
+		};
+
+		bench.run("process" + suffix, process);
+
+		// The same spread over a worker per core, should take about 1 / cores as long with enough enemies
+		bench.runThreaded("process" + suffix, process);
+
+		// Most of them are off screen
+		const sf::FloatRect screenRect(5000 * tileSize.x / 2.f - 128.f, 0.f, 256.f, 192.f);
+		bench.run("appendQuads, screen" + suffix,
+				  [&]()
+				  {
+					  vertices.clear();
+					  enemies.appendQuads(vertices, screenRect, 0.5f);
+					  doNotOptimize(vertices);
+				  });
+	}
+}
+}  // namespace EnemyBenchmarks
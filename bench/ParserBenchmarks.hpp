@@ -0,0 +1,71 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "LevelGenerator.hpp"
+#include "TMXParser.hpp"
+#include "XMLParser.hpp"
+
+namespace ParserBenchmarks
+{
+// Generates a widthInTiles by heightInTiles level the same way platformerLevelGenerator does
+bool writeMap(const std::string& path, int widthInTiles, int heightInTiles)
+{
+	LevelGeneration::Options options;
+	options.outputPath = path;
+	options.width      = widthInTiles;
+	options.height     = heightInTiles;
+	LevelGeneration::clampOptions(options);
+
+	return LevelGeneration::LevelGenerator(options).write();
+}
+
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("Parsers"))
+		return;
+
+	bench.printHeader("Parsers");
+
+	const std::string smallMapPath = "leveldata/testmap1.tmx";
+	const std::string hugeMapPath =
+		(std::filesystem::temp_directory_path() / "platformerBench_huge.tmx").string();
+
+	if (!writeMap(hugeMapPath, 4000, 120))
+	{
+		std::cerr << "Error writing " << hugeMapPath << ", skipping parser benchmarks" << std::endl;
+		return;
+	}
+
+	for (const auto& [name, path] : {std::pair<std::string, std::string>{"small map (48x18)", smallMapPath},
+									 std::pair<std::string, std::string>{"huge map (4000x120)", hugeMapPath}})
+	{
+		if (!std::ifstream(path))
+		{
+			std::cerr << "Missing " << path << ", run from the build directory" << std::endl;
+			continue;
+		}
+
+		bench.run("XMLParser::parseFile, " + name,
+				  [&]()
+				  {
+					  XMLParser parser;
+					  doNotOptimize(parser.parseFile(path));
+				  });
+
+		bench.run("TMXParser::parse, " + name,
+				  [&]()
+				  {
+					  TMXParser parser;
+					  doNotOptimize(parser.parse(path));
+				  });
+	}
+
+	std::filesystem::remove(hugeMapPath);
+}
+}  // namespace ParserBenchmarks
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "Benchmark.hpp"
+#include "BitmapFont.hpp"
+
+namespace TextBenchmarks
+{
+void run()
+{
+	auto& bench = Benchmark::Get();
+	if (!bench.shouldRun("BitmapFont"))
+		return;
+
+	bench.printHeader("BitmapFont");
+
+	// Glyph data only, there is no graphics context for the texture
+	BitmapFont font;
+	if (!font.loadFontData("assets/font/kubasta_regular_8.fnt"))
+	{
+		std::cerr << "Missing assets/font/kubasta_regular_8.fnt, run from the build directory" << std::endl;
+		return;
+	}
+
+	const std::wstring hudText   = L"GEMS: 42";
+	const std::wstring debugText = L"delta: 6944\nFPS: 144\nticks: 1\np50 6.94 p95 7.12 p99 8.03 ms";
+
+	sf::VertexArray vertices;
+
+	for (const auto& [name, text] : {std::pair<std::string, const std::wstring*>{"hud text", &hudText},
+									 std::pair<std::string, const std::wstring*>{"debug text", &debugText}})
+	{
+		bench.run("getTextDrawable, " + name, [&]() { doNotOptimize(font.getTextDrawable(*text, 2.f, 2.f)); });
+		bench.run("getTextDrawable buffer, " + name,
+				  [&]() { doNotOptimize(font.getTextDrawable(vertices, *text, 2.f, 2.f)); });
+	}
+}
+}  // namespace TextBenchmarks
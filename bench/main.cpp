@@ -0,0 +1,31 @@
+#include <iostream>
+
+#include "AllocationHooks.hpp"
+#include "AnimationBenchmarks.hpp"
+#include "AnimationCrowdBenchmarks.hpp"
+#include "Benchmark.hpp"
+#include "ChunkMapBenchmarks.hpp"
+#include "CollisionBenchmarks.hpp"
+#include "EnemyBenchmarks.hpp"
+#include "ParserBenchmarks.hpp"
+#include "TextBenchmarks.hpp"
+
+// Usage: platformerBench [suite], only suites whose name contains suite are run.
+// Needs no display, run it from the build directory so leveldata and assets are found.
+int main(int argc, char* argv[])
+{
+	std::cout << "platformerBench" << std::endl;
+	if (AllocationTracker::ENABLED)
+		std::cout << "allocs/op marked * only count the main thread" << std::endl;
+
+	if (argc > 1)
+		Benchmark::Get().setFilter(argv[1]);
+
+	ChunkMapBenchmarks::run();
+	CollisionBenchmarks::run();
+	EnemyBenchmarks::run();
+	ParserBenchmarks::run();
+	AnimationBenchmarks::run();
+	AnimationCrowdBenchmarks::run();
+	TextBenchmarks::run();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Replaces the global operator new and delete so AllocationTracker can count allocations. Include this in
+// exactly one source file of an executable, it does nothing unless built with PLATFORMER_TRACK_ALLOCATIONS.
+
+#ifdef PLATFORMER_TRACK_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#include "AllocationTracker.hpp"
+
+// GCC inlines these into the operators and then mistakes malloc and free for a mismatched new and delete
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace AllocationHooks
+{
+inline void* allocate(size_t size)
+{
+	AllocationTracker::recordAllocation(size);
+	return std::malloc(size > 0 ? size : 1);
+}
+
+inline void* allocateAligned(size_t size, size_t alignment)
+{
+	AllocationTracker::recordAllocation(size);
+#ifdef _MSC_VER
+	return _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size > 0 ? size : 1) != 0)
+		return nullptr;
+	return ptr;
+#endif
+}
+
+inline void free(void* ptr)
+{
+	if (!ptr)
+		return;
+	AllocationTracker::recordFree();
+	std::free(ptr);
+}
+
+inline void freeAligned(void* ptr)
+{
+	if (!ptr)
+		return;
+	AllocationTracker::recordFree();
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+}  // namespace AllocationHooks
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void* operator new(size_t size)
+{
+	if (auto* ptr = AllocationHooks::allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size)
+{
+	if (auto* ptr = AllocationHooks::allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return AllocationHooks::allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return AllocationHooks::allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (auto* ptr = AllocationHooks::allocateAligned(size, static_cast<size_t>(alignment)))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (auto* ptr = AllocationHooks::allocateAligned(size, static_cast<size_t>(alignment)))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationHooks::allocateAligned(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationHooks::allocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { AllocationHooks::free(ptr); }
+void operator delete[](void* ptr) noexcept { AllocationHooks::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { AllocationHooks::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { AllocationHooks::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { AllocationHooks::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { AllocationHooks::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { AllocationHooks::freeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { AllocationHooks::freeAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { AllocationHooks::freeAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { AllocationHooks::freeAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationHooks::freeAligned(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationHooks::freeAligned(ptr);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new of the calling thread. Counting only happens
+// when the project is built with PLATFORMER_TRACK_ALLOCATIONS, and the executable includes
+// AllocationHooks.hpp in exactly one of its source files. Without it all counts stay at zero.
+class AllocationTracker
+{
+public:
+#ifdef PLATFORMER_TRACK_ALLOCATIONS
+	static constexpr bool ENABLED = true;
+#else
+	static constexpr bool ENABLED = false;
+#endif
+
+	// Running totals since the thread started, take the difference of two of these to measure something
+	struct Counts
+	{
+		uint64_t allocations = 0;
+		uint64_t bytes       = 0;
+		uint64_t frees       = 0;
+
+		Counts operator-(const Counts& other) const
+		{
+			return {allocations - other.allocations, bytes - other.bytes, frees - other.frees};
+		}
+	};
+
+	static const Counts& getCounts() { return _accessCounts(); }
+
+	// Called by the operator new and delete replacements
+	static void recordAllocation(size_t size)
+	{
+		auto& counts = _accessCounts();
+		++counts.allocations;
+		counts.bytes += size;
+	}
+	static void recordFree() { ++_accessCounts().frees; }
+
+private:
+	// Plain data so it needs no dynamic initialization, which could itself allocate
+	static Counts& _accessCounts()
+	{
+		static thread_local Counts counts;
+		return counts;
+	}
+};
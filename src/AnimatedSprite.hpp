@@ -1,7 +1,14 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "KeyFrameAnimator.hpp"
 
@@ -23,6 +30,53 @@ public:
 		ORIGIN_Y = 10,
 	};
 
+	// Every KeyType, so the most timelines a clip can have
+	static constexpr size_t keyTypeCount = 11;
+
+	using Clip = KeyFrameClip<KeyType>;
+
+	// Handle of an animation, resolved from its name once so switching animations every frame is an index
+	using AnimationId = uint32_t;
+	static constexpr AnimationId noAnimation = UINT32_MAX;
+
+	// Named clips, shared by every sprite playing them (like all coins of a level) and never changed once
+	// shared. A sprite itself only keeps which animation it plays and where it is in it.
+	class AnimationSet
+	{
+	public:
+		// Ids are indices, an animation with the same name as an existing one replaces it and keeps its id
+		AnimationId add(const std::string& name, const std::shared_ptr<const Clip>& clip)
+		{
+			const AnimationId id = find(name);
+			if (id != noAnimation)
+			{
+				animations[id].second = clip;
+				return id;
+			}
+
+			animations.emplace_back(name, clip);
+			return (AnimationId)(animations.size() - 1);
+		}
+
+		AnimationId find(std::string_view name) const
+		{
+			for (size_t i = 0; i < animations.size(); ++i)
+			{
+				if (animations[i].first == name)
+					return (AnimationId)i;
+			}
+			return noAnimation;
+		}
+
+		size_t size() const { return animations.size(); }
+		bool contains(AnimationId id) const { return id < animations.size(); }
+		const std::string& getName(AnimationId id) const { return animations[id].first; }
+		const Clip& getClip(AnimationId id) const { return *animations[id].second; }
+
+	private:
+		std::vector<std::pair<std::string, std::shared_ptr<const Clip>>> animations;
+	};
+
 	explicit AnimatedSprite(const sf::Vector2f& position = sf::Vector2f(0.f, 0.f),
 							const sf::Vector2f& offset   = sf::Vector2f(0.f, 0.f))
 		: spriteOffset(offset)
@@ -42,48 +96,107 @@ public:
 
 	const sf::Sprite& get() { return sprite; }
 
-	void addAnimation(const std::string& name, const KeyFrameAnimator<KeyType>& animation)
+	// Copies of a sprite share its animations, adding one to a shared set gives this sprite a set of its own.
+	// The returned id stays valid for every sprite sharing the set.
+	AnimationId addAnimation(const std::string& name, const KeyFrameAnimator<KeyType>& animation)
 	{
-		animations[name] = animation;
-		if (currentAnimation == "")
-			currentAnimation = name;
+		auto newAnimations = animations ? std::make_shared<AnimationSet>(*animations)
+										: std::make_shared<AnimationSet>();
+		const AnimationId id = newAnimations->add(name, animation.getClip());
+
+		setAnimations(newAnimations, false);
+		return id;
 	}
-	bool setAnimation(const std::string& name, bool resetAnimation = true)
+	// Plays the first animation of the set, or the one with the same name as the current one if there is one
+	void setAnimations(const std::shared_ptr<const AnimationSet>& val, bool resetAnimation = true)
 	{
-		if (!animations.count(name))
-			return false;
+		const std::string current = getCurrentAnimationName();
+		animations                = val;
 
-		currentAnimation = name;
+		currentAnimation = findAnimation(current);
+		if (currentAnimation == noAnimation)
+			currentAnimation = 0;
 
+		_rewindCursors();
 		if (resetAnimation)
 			resetCurrentAnimation(false);
+	}
+	const std::shared_ptr<const AnimationSet>& getAnimations() const { return animations; }
 
-		return false;
+	// noAnimation if there is none called name
+	AnimationId findAnimation(std::string_view name) const
+	{
+		return animations ? animations->find(name) : noAnimation;
 	}
-	const std::string& getCurrentAnimation() { return currentAnimation; }
 
-	void resetCurrentAnimation(bool soft = true)
+	// Without resetting, the new animation continues from the time the previous one was at. Returns false
+	// for an id that isn't in the set.
+	bool setAnimation(AnimationId id, bool resetAnimation = true)
 	{
-		_handle_animation_return_vector(animations[currentAnimation].reset(soft));
+		if (!animations || !animations->contains(id))
+			return false;
+
+		if (id != currentAnimation)
+		{
+			currentAnimation = id;
+			_rewindCursors();
+		}
+
+		if (resetAnimation)
+			resetCurrentAnimation(false);
+
+		return true;
 	}
-	bool ended() { return animations[currentAnimation].ended(); }
-	bool ended(const std::string& name)
+	// Looks the name up first, ids from findAnimation() are better for switching every frame
+	bool setAnimation(std::string_view name, bool resetAnimation = true)
 	{
-		if (!animations.count(name))
-			return ended();
+		return setAnimation(findAnimation(name), resetAnimation);
+	}
+	AnimationId getCurrentAnimation() const { return _hasAnimation() ? currentAnimation : noAnimation; }
+	const std::string& getCurrentAnimationName() const
+	{
+		static const std::string none;
+		return _hasAnimation() ? animations->getName(currentAnimation) : none;
+	}
 
-		return animations[name].ended();
+	void resetCurrentAnimation(bool soft = true)
+	{
+		if (_hasAnimation())
+			animations->getClip(currentAnimation)
+				.reset(playhead, [this](KeyType key, float value) { _applyAnimationValue(key, value); }, soft);
 	}
+	bool ended() const { return !_hasAnimation() || animations->getClip(currentAnimation).ended(playhead); }
 
 	void tick(int delta)
 	{
-		_handle_animation_return_vector(
-			animations[currentAnimation].tick((int)((float)delta * animationSpeedMultiplier)));
+		if (_hasAnimation())
+			animations->getClip(currentAnimation)
+				.tick(playhead, (int)((float)delta * animationSpeedMultiplier),
+					  [this](KeyType key, float value) { _applyAnimationValue(key, value); });
 	}
 
-	void setTexture(const sf::Texture& val) { sprite.setTexture(val); }
-	void setTextureRect(const sf::IntRect& val) { sprite.setTextureRect(val); }
-	const sf::Sprite& getSprite() { return sprite; }
+	void setTexture(const sf::Texture& val)
+	{
+		sprite.setTexture(val);
+		textureOffset = sf::Vector2i(0, 0);
+	}
+	// For textures packed into an atlas, texture rects (including animated ones) are then relative to
+	// regionOffset instead of the top left corner of the texture
+	void setTexture(const sf::Texture& val, const sf::Vector2i& regionOffset)
+	{
+		sprite.setTexture(val);
+		sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left - textureOffset.x + regionOffset.x,
+										  sprite.getTextureRect().top - textureOffset.y + regionOffset.y,
+										  sprite.getTextureRect().width, sprite.getTextureRect().height));
+		textureOffset = regionOffset;
+	}
+	void setTextureRect(const sf::IntRect& val)
+	{
+		sprite.setTextureRect(
+			sf::IntRect(val.left + textureOffset.x, val.top + textureOffset.y, val.width, val.height));
+	}
+	const sf::Sprite& getSprite() const { return sprite; }
+	const sf::Vector2i& getTextureOffset() const { return textureOffset; }
 
 	void setPosition(const sf::Vector2f& val) { sprite.setPosition(val + spriteOffset); }
 	void move(const sf::Vector2f& offset) { sprite.move(offset); }
@@ -107,70 +220,73 @@ public:
 private:
 	sf::Sprite sprite;
 	sf::Vector2f spriteOffset;
+	sf::Vector2i textureOffset = sf::Vector2i(0, 0);
 
-	std::map<std::string, KeyFrameAnimator<KeyType>, std::less<>> animations;
-	std::string currentAnimation = "";
+	std::shared_ptr<const AnimationSet> animations;
+	AnimationId currentAnimation = 0;
+	KeyFramePlayhead<std::array<uint32_t, keyTypeCount>> playhead;
 
 	float animationSpeedMultiplier = 1.f;
 
-	void _handle_animation_return_vector(std::vector<std::pair<KeyType, float>> vector)
+	bool _hasAnimation() const { return animations && animations->contains(currentAnimation); }
+	void _rewindCursors() { playhead.cursors.fill(0); }
+
+	// Animation values are applied straight from the animator as it produces them
+	void _applyAnimationValue(KeyType key, float value)
 	{
-		for (const auto& pair : vector)
+		switch (key)
 		{
-			switch (pair.first)
-			{
-				case KeyType::RECT_X:
-					sprite.setTextureRect(sf::IntRect(pair.second, sprite.getTextureRect().top,
-													  sprite.getTextureRect().width, sprite.getTextureRect().height));
-					break;
-
-				case KeyType::RECT_Y:
-					sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, pair.second,
-													  sprite.getTextureRect().width, sprite.getTextureRect().height));
-					break;
-
-				case KeyType::RECT_W:
-					sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, sprite.getTextureRect().top,
-													  pair.second, sprite.getTextureRect().height));
-					break;
-
-				case KeyType::RECT_H:
-					sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, sprite.getTextureRect().top,
-													  sprite.getTextureRect().width, pair.second));
-					break;
-
-				case KeyType::OFFSET_X:
-					spriteOffset.x = pair.second;
-					break;
-
-				case KeyType::OFFSET_Y:
-					spriteOffset.y = pair.second;
-					break;
-
-				case KeyType::ROTATION:
-					sprite.setRotation(pair.second);
-					break;
-
-				case KeyType::SCALE_X:
-					sprite.setScale(pair.second, sprite.getScale().y);
-					break;
-
-				case KeyType::SCALE_Y:
-					sprite.setScale(sprite.getScale().x, pair.second);
-					break;
-
-				case KeyType::ORIGIN_X:
-					sprite.setOrigin(pair.second, sprite.getOrigin().y);
-					break;
-
-				case KeyType::ORIGIN_Y:
-					sprite.setOrigin(sprite.getOrigin().x, pair.second);
-					break;
-
-				default:
-					std::cerr << "Unexpected KeyType in instance of AnimatedSprite" << std::endl;
-					break;
-			}
+			case KeyType::RECT_X:
+				sprite.setTextureRect(sf::IntRect(value + textureOffset.x, sprite.getTextureRect().top,
+												  sprite.getTextureRect().width, sprite.getTextureRect().height));
+				break;
+
+			case KeyType::RECT_Y:
+				sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, value + textureOffset.y,
+												  sprite.getTextureRect().width, sprite.getTextureRect().height));
+				break;
+
+			case KeyType::RECT_W:
+				sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, sprite.getTextureRect().top,
+												  value, sprite.getTextureRect().height));
+				break;
+
+			case KeyType::RECT_H:
+				sprite.setTextureRect(sf::IntRect(sprite.getTextureRect().left, sprite.getTextureRect().top,
+												  sprite.getTextureRect().width, value));
+				break;
+
+			case KeyType::OFFSET_X:
+				spriteOffset.x = value;
+				break;
+
+			case KeyType::OFFSET_Y:
+				spriteOffset.y = value;
+				break;
+
+			case KeyType::ROTATION:
+				sprite.setRotation(value);
+				break;
+
+			case KeyType::SCALE_X:
+				sprite.setScale(value, sprite.getScale().y);
+				break;
+
+			case KeyType::SCALE_Y:
+				sprite.setScale(sprite.getScale().x, value);
+				break;
+
+			case KeyType::ORIGIN_X:
+				sprite.setOrigin(value, sprite.getOrigin().y);
+				break;
+
+			case KeyType::ORIGIN_Y:
+				sprite.setOrigin(sprite.getOrigin().x, value);
+				break;
+
+			default:
+				std::cerr << "Unexpected KeyType in instance of AnimatedSprite" << std::endl;
+				break;
 		}
 	}
 };
\ No newline at end of file
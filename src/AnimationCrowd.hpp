@@ -0,0 +1,461 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// SSE2 is part of every x86-64 CPU, PLATFORMER_NO_SIMD forces the plain loops
+#if !defined(PLATFORMER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PLATFORMER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AnimatedSprite.hpp"
+#include "JobSystem.hpp"
+#include "SpriteBatch.hpp"
+
+// Many copies of one animated sprite (like all coins of a level) played together. Instead of every copy ticking
+// an AnimatedSprite of its own and pushing each value through the sf::Sprite setters, the clip is evaluated for
+// all of them at once over structure of arrays, four instances at a time with SSE2, and the values go straight
+// into SpriteBatch vertices. Instances look the same as AnimatedSprite copies ticked with the same deltas.
+class AnimationCrowd
+{
+public:
+	// Stays the same for an instance as long as it exists, unlike its index
+	using Handle                        = uint32_t;
+	static constexpr Handle invalidHandle = UINT32_MAX;
+
+	AnimationCrowd()  = default;
+	~AnimationCrowd() = default;
+
+	// Takes the texture, texture rect, color, offset, rotation, scale, origin, speed and current animation of
+	// sprite. Removes every instance.
+	void setSprite(const AnimatedSprite& sprite)
+	{
+		clear();
+
+		const auto& base = sprite.getSprite();
+		texture          = base.getTexture();
+		color            = base.getColor();
+		textureOffset    = sprite.getTextureOffset();
+		speedMultiplier  = sprite.getAnimationSpeedMultiplier();
+
+		const auto& rect = base.getTextureRect();
+		baseValues       = {(float)(rect.left - textureOffset.x),
+							(float)(rect.top - textureOffset.y),
+							(float)rect.width,
+							(float)rect.height,
+							sprite.getOffset().x,
+							sprite.getOffset().y,
+							base.getRotation(),
+							base.getScale().x,
+							base.getScale().y,
+							base.getOrigin().x,
+							base.getOrigin().y};
+
+		tracks.clear();
+		rotationAnimated = false;
+
+		const auto& animations = sprite.getAnimations();
+		animated               = animations && animations->contains(sprite.getCurrentAnimation());
+		if (!animated)
+			return;
+
+		const auto& clip = animations->getClip(sprite.getCurrentAnimation());
+		duration         = clip.getDuration();
+		loop             = clip.getLoop();
+
+		for (const auto& timeline : clip.getTimelines())
+		{
+			Track track;
+			track.key = timeline.first;
+			rotationAnimated |= track.key == KeyType::ROTATION;
+
+			const auto& keys = timeline.second.getKeys();
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				Segment segment;
+				segment.time  = keys[i].time;
+				segment.value = keys[i].targetValue;
+
+				// Same arithmetic as KeyFrameTimeline::advance(), so the results match it bit for bit
+				if (i + 1 < keys.size() && keys[i + 1].continuous)
+				{
+					segment.interpolate = true;
+					segment.nextTime    = keys[i + 1].time;
+					segment.span        = (float)(keys[i + 1].time - keys[i].time);
+					segment.difference  = keys[i + 1].targetValue - keys[i].targetValue;
+				}
+
+				track.segments.push_back(segment);
+			}
+
+			tracks.push_back(std::move(track));
+		}
+	}
+
+	// position is where the AnimatedSprite copy would have been placed with setPosition()
+	Handle spawn(const sf::Vector2f& position)
+	{
+		Handle handle;
+		if (freeHandles.empty())
+		{
+			handle = (Handle)handleIndices.size();
+			handleIndices.push_back(0);
+			// Room for every handle to be freed, so removing never allocates
+			freeHandles.reserve(handleIndices.capacity());
+		}
+		else
+		{
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+		}
+
+		handleIndices[handle] = (uint32_t)size();
+		indexHandles.push_back(handle);
+
+		positionX.push_back(position.x);
+		positionY.push_back(position.y);
+		elapsed.push_back(0);
+		for (auto& track : tracks)
+			track.values.push_back(baseValues[(size_t)track.key]);
+
+		return handle;
+	}
+
+	// The last instance takes the removed one's place. Does nothing for invalidHandle.
+	void remove(Handle handle)
+	{
+		if (handle == invalidHandle)
+			return;
+
+		const size_t index = handleIndices[handle];
+		const size_t last  = size() - 1;
+		if (index != last)
+		{
+			positionX[index] = positionX[last];
+			positionY[index] = positionY[last];
+			elapsed[index]   = elapsed[last];
+			for (auto& track : tracks)
+				track.values[index] = track.values[last];
+
+			indexHandles[index]                = indexHandles[last];
+			handleIndices[indexHandles[index]] = (uint32_t)index;
+		}
+
+		positionX.pop_back();
+		positionY.pop_back();
+		elapsed.pop_back();
+		for (auto& track : tracks)
+			track.values.pop_back();
+		indexHandles.pop_back();
+
+		freeHandles.push_back(handle);
+	}
+
+	void clear()
+	{
+		positionX.clear();
+		positionY.clear();
+		elapsed.clear();
+		for (auto& track : tracks)
+			track.values.clear();
+		handleIndices.clear();
+		indexHandles.clear();
+		freeHandles.clear();
+	}
+
+	size_t size() const { return positionX.size(); }
+	bool empty() const { return positionX.empty(); }
+
+	void setPosition(Handle handle, const sf::Vector2f& position)
+	{
+		positionX[handleIndices[handle]] = position.x;
+		positionY[handleIndices[handle]] = position.y;
+	}
+
+	// Advances every instance by delta, times the sprite's animation speed
+	void tick(int delta)
+	{
+		if (!animated)
+			return;
+
+		const int scaledDelta = (int)((float)delta * speedMultiplier);
+		JobSystem::Get().parallelFor(size(), tickGrainSize,
+									 [this, scaledDelta](size_t begin, size_t end)
+									 {
+										 _advance(scaledDelta, begin, end);
+										 for (auto& track : tracks)
+											 _evaluate(track, begin, end);
+									 });
+	}
+
+	// One quad per instance, nothing without a texture
+	void appendQuads(SpriteBatch& outBatch, int layer = 0) const
+	{
+		if (!texture || empty())
+			return;
+
+		sf::Vertex* vertices = outBatch.appendQuads(*texture, layer, size());
+
+		const size_t count        = size();
+		const size_t trackCount   = tracks.size();
+		const float* x            = positionX.data();
+		const float* y            = positionY.data();
+		const sf::Color quadColor = color;
+		const sf::Vector2i offset = textureOffset;
+		const bool rotating       = rotationAnimated;
+
+		std::array<size_t, AnimatedSprite::keyTypeCount> trackKeys         = {};
+		std::array<const float*, AnimatedSprite::keyTypeCount> trackValues = {};
+		for (size_t t = 0; t < trackCount; ++t)
+		{
+			trackKeys[t]   = (size_t)tracks[t].key;
+			trackValues[t] = tracks[t].values.data();
+		}
+
+		std::array<float, AnimatedSprite::keyTypeCount> values = baseValues;
+		sf::Vector2f rotation                                   = _rotationCosineSine(values);
+		for (size_t i = 0; i < count; ++i)
+		{
+			for (size_t t = 0; t < trackCount; ++t)
+				values[trackKeys[t]] = trackValues[t][i];
+
+			if (rotating)
+				rotation = _rotationCosineSine(values);
+
+			_writeQuad(values, rotation, x[i], y[i], quadColor, offset, vertices + 4 * i);
+		}
+	}
+
+private:
+	using KeyType = AnimatedSprite::KeyType;
+
+	// A key, and how to interpolate towards the next one when that one is continuous
+	struct Segment
+	{
+		int time         = 0;
+		float value      = 0.f;
+		bool interpolate = false;
+		int nextTime     = 0;
+		float span       = 1.f;
+		float difference = 0.f;
+	};
+
+	// One timeline of the clip and its current value for every instance
+	struct Track
+	{
+		KeyType key = KeyType::RECT_X;
+		std::vector<Segment> segments;
+		std::vector<float> values;
+	};
+
+	// Multiple of four so only the last range has a scalar tail
+	static constexpr size_t tickGrainSize = 1024;
+
+	const sf::Texture* texture = nullptr;
+	sf::Color color            = sf::Color::White;
+	sf::Vector2i textureOffset = sf::Vector2i(0, 0);
+	float speedMultiplier      = 1.f;
+
+	// Indexed by KeyType, values of whatever the clip doesn't animate
+	std::array<float, AnimatedSprite::keyTypeCount> baseValues = {};
+
+	// The clip is copied into tracks, nothing is animated without one
+	bool animated         = false;
+	bool rotationAnimated = false;
+	int duration          = 0;
+	bool loop             = true;
+	std::vector<Track> tracks;
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<int32_t> elapsed;
+
+	std::vector<uint32_t> handleIndices;
+	std::vector<Handle> indexHandles;
+	std::vector<Handle> freeHandles;
+
+	// Same as KeyFrameClip::tick(), ended instances either wrap around or stay where they are
+	void _advance(int delta, size_t begin, size_t end)
+	{
+		int32_t* const time = elapsed.data();
+		size_t i            = begin;
+
+#ifdef PLATFORMER_SSE2
+		const __m128i durationV = _mm_set1_epi32(duration);
+		const __m128i deltaV    = _mm_set1_epi32(delta);
+
+		for (; i + 4 <= end; i += 4)
+		{
+			const __m128i t       = _mm_loadu_si128((const __m128i*)(time + i));
+			const __m128i playing = _mm_cmplt_epi32(t, durationV);
+			const __m128i ended   = loop ? _mm_sub_epi32(t, durationV) : t;
+
+			const __m128i next = _select(playing, _mm_add_epi32(t, deltaV), ended);
+			_mm_storeu_si128((__m128i*)(time + i), next);
+
+			if (!loop || duration <= 0)
+				continue;
+
+			// Wrapped around but still past the end, only after a delta longer than the whole clip
+			const __m128i pastEnd = _mm_cmpeq_epi32(_mm_cmplt_epi32(next, durationV), _mm_setzero_si128());
+			const int overshot    = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(playing, pastEnd)));
+			for (size_t j = 0; overshot != 0 && j < 4; ++j)
+			{
+				while ((overshot >> j) & 1 && time[i + j] >= duration)
+					time[i + j] -= duration;
+			}
+		}
+#endif
+
+		for (; i < end; ++i)
+		{
+			if (time[i] < duration)
+				time[i] += delta;
+			else if (loop)
+			{
+				do
+				{
+					time[i] -= duration;
+				} while (duration > 0 && time[i] >= duration);
+			}
+		}
+	}
+
+	// Value of track at each instance's time: the last key passed, or interpolated towards the next key when
+	// that one is continuous. Before the first key the value stays what it was, like with AnimatedSprite.
+	// Deliberately compares every instance with every key instead of keeping cursors like KeyFrameTimeline,
+	// O(keys) per instance but branch free on four lanes at once, which wins for the few keys crowd clips
+	// like a coin spin have. Clips with dozens of keys would want a cursor per instance.
+	void _evaluate(Track& track, size_t begin, size_t end) const
+	{
+		const int32_t* const time = elapsed.data();
+		float* const values       = track.values.data();
+		const Segment* segments   = track.segments.data();
+		const size_t count        = track.segments.size();
+		size_t i                  = begin;
+
+#ifdef PLATFORMER_SSE2
+		for (; i + 4 <= end; i += 4)
+		{
+			const __m128i t = _mm_loadu_si128((const __m128i*)(time + i));
+			__m128 value    = _mm_loadu_ps(values + i);
+
+			// Keys are sorted, so going through all of them leaves the last one passed
+			for (size_t k = 0; k < count; ++k)
+			{
+				const Segment& segment  = segments[k];
+				const __m128i notPassed = _mm_cmplt_epi32(t, _mm_set1_epi32(segment.time));
+				value = _select(_mm_castsi128_ps(notPassed), value, _mm_set1_ps(segment.value));
+
+				if (!segment.interpolate)
+					continue;
+
+				const __m128i between =
+					_mm_andnot_si128(notPassed, _mm_cmplt_epi32(t, _mm_set1_epi32(segment.nextTime)));
+				const __m128 progress =
+					_mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(t, _mm_set1_epi32(segment.time))),
+							   _mm_set1_ps(segment.span));
+				const __m128 interpolated = _mm_add_ps(_mm_mul_ps(progress, _mm_set1_ps(segment.difference)),
+													   _mm_set1_ps(segment.value));
+				value = _select(_mm_castsi128_ps(between), interpolated, value);
+			}
+
+			_mm_storeu_ps(values + i, value);
+		}
+#endif
+
+		for (; i < end; ++i)
+		{
+			for (size_t k = 0; k < count && time[i] >= segments[k].time; ++k)
+			{
+				const Segment& segment = segments[k];
+				if (segment.interpolate && time[i] < segment.nextTime)
+					values[i] = ((float)(time[i] - segment.time) / segment.span) * segment.difference + segment.value;
+				else
+					values[i] = segment.value;
+			}
+		}
+	}
+
+#ifdef PLATFORMER_SSE2
+	// mask ? a : b for every lane
+	static __m128i _select(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+	static __m128 _select(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+#endif
+
+	// Same as sf::Transformable, sf::Sprite keeps its rotation in [0, 360)
+	static sf::Vector2f _rotationCosineSine(const std::array<float, AnimatedSprite::keyTypeCount>& values)
+	{
+		float rotation = std::fmod(values[(size_t)KeyType::ROTATION], 360.f);
+		if (rotation < 0.f)
+			rotation += 360.f;
+
+		const float angle = -rotation * 3.141592654f / 180.f;
+		return {std::cos(angle), std::sin(angle)};
+	}
+
+	// The four vertices SpriteBatch::add() would make of an AnimatedSprite with these values
+	static void _writeQuad(const std::array<float, AnimatedSprite::keyTypeCount>& values, const sf::Vector2f& rotation,
+						   float x, float y, sf::Color color, sf::Vector2i textureOffset, sf::Vertex* outVertices)
+	{
+		// Rect values are truncated to whole pixels, as AnimatedSprite does
+		const int left   = (int)(values[(size_t)KeyType::RECT_X] + (float)textureOffset.x);
+		const int top    = (int)(values[(size_t)KeyType::RECT_Y] + (float)textureOffset.y);
+		const int width  = (int)values[(size_t)KeyType::RECT_W];
+		const int height = (int)values[(size_t)KeyType::RECT_H];
+
+		const float sizeX = (float)std::abs(width);
+		const float sizeY = (float)std::abs(height);
+
+		// Same transform as sf::Transformable
+		const float cosine  = rotation.x;
+		const float sine    = rotation.y;
+		const float scaleX  = values[(size_t)KeyType::SCALE_X];
+		const float scaleY  = values[(size_t)KeyType::SCALE_Y];
+		const float originX = values[(size_t)KeyType::ORIGIN_X];
+		const float originY = values[(size_t)KeyType::ORIGIN_Y];
+
+		// The sprite's position includes its offset
+		const float positionX = x + values[(size_t)KeyType::OFFSET_X];
+		const float positionY = y + values[(size_t)KeyType::OFFSET_Y];
+
+		const float sxc = scaleX * cosine;
+		const float syc = scaleY * cosine;
+		const float sxs = scaleX * sine;
+		const float sys = scaleY * sine;
+		const float tx  = -originX * sxc - originY * sys + positionX;
+		const float ty  = originX * sxs - originY * syc + positionY;
+
+		const std::array<sf::Vector2f, 4> corners = {sf::Vector2f(0.f, 0.f), sf::Vector2f(sizeX, 0.f),
+													 sf::Vector2f(sizeX, sizeY), sf::Vector2f(0.f, sizeY)};
+
+		// Negative sizes flip the texture, same as with sf::Sprite
+		const float texLeft   = (float)left;
+		const float texTop    = (float)top;
+		const float texRight  = (float)(left + width);
+		const float texBottom = (float)(top + height);
+
+		const std::array<sf::Vector2f, 4> texCoords = {sf::Vector2f(texLeft, texTop), sf::Vector2f(texRight, texTop),
+													   sf::Vector2f(texRight, texBottom),
+													   sf::Vector2f(texLeft, texBottom)};
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			outVertices[i].position  = sf::Vector2f(sxc * corners[i].x + sys * corners[i].y + tx,
+													-sxs * corners[i].x + syc * corners[i].y + ty);
+			outVertices[i].color     = color;
+			outVertices[i].texCoords = texCoords[i];
+		}
+	}
+};
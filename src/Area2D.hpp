@@ -8,34 +8,54 @@ class Area2D
 public:
 	Area2D(const sf::Vector2f& position = sf::Vector2f(0, 0), const sf::Vector2f& size = sf::Vector2f(16, 16),
 		   const sf::Color& color = sf::Color(0, 0, 200, 96))
-	{
-		area.setPosition(position);
-		area.setSize(size);
-		area.setFillColor(color);
-		area.setOutlineColor(sf::Color(255, 255, 255, 96));
-		area.setOutlineThickness(-0.5f);
-	}
+		: rect(position, size), color(color)
+	{}
 	~Area2D() = default;
 
-	const sf::RectangleShape& getRectangleShape() { return area; }
-	sf::Vector2f getCenter() { return area.getPosition() + sf::Vector2f(area.getSize().x / 2, area.getSize().y / 2); }
+	// Built on demand, only meant for drawing (debug mode)
+	sf::RectangleShape getRectangleShape() const
+	{
+		sf::RectangleShape shape(getSize());
+		shape.setPosition(getPosition());
+		shape.setFillColor(color);
+		shape.setOutlineColor(sf::Color(255, 255, 255, 96));
+		shape.setOutlineThickness(-0.5f);
+		return shape;
+	}
+	sf::Vector2f getCenter() const { return {rect.left + rect.width / 2.f, rect.top + rect.height / 2.f}; }
 
-	void setPosition(const sf::Vector2f& position) { area.setPosition(position); }
-	void setSize(const sf::Vector2f& size) { area.setSize(size); }
-	void setColor(const sf::Color& color) { area.setFillColor(color); }
+	void setPosition(const sf::Vector2f& position)
+	{
+		rect.left = position.x;
+		rect.top  = position.y;
+	}
+	void setSize(const sf::Vector2f& size)
+	{
+		rect.width  = size.x;
+		rect.height = size.y;
+	}
+	void setColor(const sf::Color& color) { this->color = color; }
 
-	const sf::Vector2f& getPosition() { return area.getPosition(); }
-	const sf::Vector2f& getSize() { return area.getSize(); }
-	const sf::Color& getColor() { return area.getFillColor(); }
-	sf::FloatRect getRect() { return {area.getPosition(), area.getSize()}; }
+	sf::Vector2f getPosition() const { return {rect.left, rect.top}; }
+	sf::Vector2f getSize() const { return {rect.width, rect.height}; }
+	const sf::Color& getColor() const { return color; }
+	const sf::FloatRect& getRect() const { return rect; }
 
-	void move(const sf::Vector2f& offset) { area.move(offset); }
+	void move(const sf::Vector2f& offset)
+	{
+		rect.left += offset.x;
+		rect.top += offset.y;
+	}
 
-	bool intersects(Area2D& other)
+	// Touching edges don't count as intersecting, same as sf::Rect::intersects.
+	// Evaluates all four comparisons, which is cheaper than branching on each of them.
+	bool intersects(const Area2D& other) const
 	{
-		return other.getRectangleShape().getGlobalBounds().intersects(area.getGlobalBounds());
+		return (rect.left < other.rect.left + other.rect.width) & (other.rect.left < rect.left + rect.width) &
+			   (rect.top < other.rect.top + other.rect.height) & (other.rect.top < rect.top + rect.height);
 	}
 
 protected:
-	sf::RectangleShape area;
-};
\ No newline at end of file
+	sf::FloatRect rect;
+	sf::Color color;
+};
@@ -18,11 +18,18 @@ public:
 
 	bool create(const std::string& texturePath, const std::string& FNTPath)
 	{
-		XMLParser parser;
-
 		if (!fontTexture.loadFromFile(texturePath))
 			return false;
 
+		return loadFontData(FNTPath);
+	}
+
+	// Only the glyph data, without a texture (and so without needing a graphics context). Enough for
+	// laying out text, drawing it needs a texture from create() or setFontTexture().
+	bool loadFontData(const std::string& FNTPath)
+	{
+		XMLParser parser;
+
 		if (!parser.parseFile(FNTPath))
 			return false;
 
@@ -36,6 +43,22 @@ public:
 															  int monospaced         = 0)
 	{
 		sf::VertexArray textDrawable(sf::Quads);
+		const auto bounds = getTextDrawable(textDrawable, str, x, y, color, monospaced);
+		return {textDrawable, bounds};
+	}
+	std::pair<sf::VertexArray, sf::FloatRect> getTextDrawable(const std::wstring& str, const sf::Vector2f& pos,
+									const sf::Color& color = sf::Color::White, int monospaced = 0)
+	{
+		return getTextDrawable(str, pos.x, pos.y, color, monospaced);
+	}
+
+	// Buffer filling version, outTextDrawable is cleared and refilled so text drawn every frame can keep
+	// reusing its memory. Returns the bounds of the text.
+	sf::FloatRect getTextDrawable(sf::VertexArray& outTextDrawable, const std::wstring& str, float x, float y,
+								  const sf::Color& color = sf::Color::White, int monospaced = 0)
+	{
+		outTextDrawable.clear();
+		outTextDrawable.setPrimitiveType(sf::Quads);
 
 		int line                 = 0;
 		float accumulatedXOffset = x;
@@ -51,26 +74,29 @@ public:
 				accumulatedXOffset = x;
 				continue;
 			}
-			if (!fontCharacters.count(ch))
+			const auto found = fontCharacters.find(ch);
+			if (found == fontCharacters.end())
 				continue;
 
-			const auto data = fontCharacters[ch];
-			const auto rect = data.rect;
+			const auto& data = found->second;
+			const auto rect = sf::IntRect(data.rect.left + glyphOffset.x, data.rect.top + glyphOffset.y,
+										  data.rect.width, data.rect.height);
 
 			const float displayPointLeft = accumulatedXOffset + data.offset.x;
 			const float displayPointTop  = y + data.offset.y + line * lineHeight + additionalSpacing.y;
 
-			textDrawable.append(
+			outTextDrawable.append(
 				sf::Vertex(sf::Vector2f(displayPointLeft, displayPointTop), color, sf::Vector2f(rect.left, rect.top)));
 
-			textDrawable.append(sf::Vertex(sf::Vector2f(displayPointLeft + rect.width, displayPointTop), color,
-										   sf::Vector2f(rect.left + rect.width, rect.top)));
+			outTextDrawable.append(sf::Vertex(sf::Vector2f(displayPointLeft + rect.width, displayPointTop), color,
+											  sf::Vector2f(rect.left + rect.width, rect.top)));
 
-			textDrawable.append(sf::Vertex(sf::Vector2f(displayPointLeft + rect.width, displayPointTop + rect.height),
-										   color, sf::Vector2f(rect.left + rect.width, rect.top + rect.height)));
+			outTextDrawable.append(
+				sf::Vertex(sf::Vector2f(displayPointLeft + rect.width, displayPointTop + rect.height), color,
+						   sf::Vector2f(rect.left + rect.width, rect.top + rect.height)));
 
-			textDrawable.append(sf::Vertex(sf::Vector2f(displayPointLeft, displayPointTop + rect.height), color,
-										   sf::Vector2f(rect.left, rect.top + rect.height)));
+			outTextDrawable.append(sf::Vertex(sf::Vector2f(displayPointLeft, displayPointTop + rect.height), color,
+											  sf::Vector2f(rect.left, rect.top + rect.height)));
 
 			accumulatedXOffset +=
 				monospaced == 0 ? data.xAdvance + additionalSpacing.x : monospaced * (monospaced / data.xAdvance);
@@ -79,15 +105,23 @@ public:
 			totalHeight = std::max(totalHeight, displayPointTop + rect.height);
 		}
 
-		return {textDrawable, {x, y, maxAccumulatedXOffset-x, totalHeight-y}};
+		return {x, y, maxAccumulatedXOffset-x, totalHeight-y};
 	}
-	std::pair<sf::VertexArray, sf::FloatRect> getTextDrawable(const std::wstring& str, const sf::Vector2f& pos,
-									const sf::Color& color = sf::Color::White, int monospaced = 0)
+	sf::FloatRect getTextDrawable(sf::VertexArray& outTextDrawable, const std::wstring& str, const sf::Vector2f& pos,
+								  const sf::Color& color = sf::Color::White, int monospaced = 0)
 	{
-		return getTextDrawable(str, pos.x, pos.y, color, monospaced);
+		return getTextDrawable(outTextDrawable, str, pos.x, pos.y, color, monospaced);
 	}
 
-	const sf::Texture& getFontTexture() { return fontTexture; }
+	const sf::Texture& getFontTexture() { return externalTexture ? *externalTexture : fontTexture; }
+
+	// Draw glyphs from a copy of the font page placed at regionOffset in another texture (like an atlas)
+	// instead of the loaded one. texture has to outlive the font.
+	void setFontTexture(const sf::Texture& texture, const sf::Vector2i& regionOffset)
+	{
+		externalTexture = &texture;
+		glyphOffset     = regionOffset;
+	}
 
 	void setAdditionalSpacing(const sf::Vector2i& val) { additionalSpacing = val; }
 	const sf::Vector2i& getAdditionalSpacing() { return additionalSpacing; }
@@ -98,6 +132,8 @@ private:
 	int size         = 0;
 
 	sf::Texture fontTexture;
+	const sf::Texture* externalTexture = nullptr;
+	sf::Vector2i glyphOffset           = sf::Vector2i(0, 0);
 
 	struct BitmapCharacterData
 	{
@@ -1,16 +1,22 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-#include <memory>
+#include <array>
+#include <optional>
 #include <vector>
 
 #include "GravityEntity.hpp"
 #include "KeyFrameAnimator.hpp"
 #include "TMXParser.hpp"
+#include "Tracing.hpp"
 
 class Camera
 {
 public:
-	Camera() { transitionAnimator.lock(); };
+	Camera()
+	{
+		// An entity and a camera value at most, so the first transition doesn't grow it
+		transitionValues.reserve(2);
+	};
 	~Camera() = default;
 
 	void findCameraZones(const TMXMap& map)
@@ -22,15 +28,29 @@ public:
 		}
 	}
 
-	void setView(const sf::View val) { view = val; }
+	void setView(const sf::View val)
+	{
+		view           = val;
+		previousCenter = val.getCenter();
+	}
 	const sf::View& getView() { return view; }
 
-	bool isInTransitionAnimation() { return !transitionAnimator.ended(); }
+	// For rendering between simulation ticks, call savePreviousView() at the start of every tick
+	void savePreviousView() { previousCenter = view.getCenter(); }
+	sf::View getInterpolatedView(float alpha) const
+	{
+		auto toRet = view;
+		toRet.setCenter(previousCenter + (view.getCenter() - previousCenter) * alpha);
+		return toRet;
+	}
+	sf::FloatRect getViewRect() const { return {view.getCenter() - view.getSize() / 2.f, view.getSize()}; }
+
+	bool isInTransitionAnimation() { return !transitionAnimators[activeTransition].ended(); }
 
 	void transitionAnimationTick(sf::Int64 delta, GravityEntity& outEntity)
 	{
-		auto vec = transitionAnimator.tick(delta);
-		for (const auto& pair : vec)
+		transitionAnimators[activeTransition].tick(delta, transitionValues);
+		for (const auto& pair : transitionValues)
 		{
 			switch (pair.first)
 			{
@@ -53,14 +73,17 @@ public:
 	void followEntity(GravityEntity& outEntity, float stopMarginHor, float stopMarginVer, bool restrictView = true,
 					  bool restrictEntity = true)
 	{
+		TraceZone zone("Camera::followEntity");
+
 		view.setCenter(outEntity.getPosition());
 
-		std::vector<std::shared_ptr<CameraZone>> activeCameraZones;
+		// Copies, so only the one kept as lastCameraZone remembers it already started a transition
+		activeCameraZones.clear();
 
 		// Special handling for lastCameraZone to avoid duplicates of it.
 		// Always handled first so if entity wasn't supposed to get out of
 		// it he will be forced to stay inside.
-		if (lastCameraZone != nullptr)
+		if (lastCameraZone)
 		{
 			if (restrictView)
 				handleRestrictView(*lastCameraZone);
@@ -75,17 +98,17 @@ public:
 				outEntity.getPosition().y > cameraZone.bounds.top &&
 				outEntity.getPosition().y < cameraZone.bounds.top + cameraZone.bounds.height)
 
-				activeCameraZones.push_back(std::make_shared<CameraZone>(cameraZone));
+				activeCameraZones.push_back(cameraZone);
 		}
 
 		for (auto&& cameraZone : activeCameraZones)
 		{
-			cameraZone->canInitiateTransition = true;
+			cameraZone.canInitiateTransition = true;
 
 			if (restrictView)
-				handleRestrictView(*cameraZone);
+				handleRestrictView(cameraZone);
 			if (restrictEntity)
-				handleRestrictEntity(outEntity, *cameraZone, stopMarginHor, stopMarginVer);
+				handleRestrictEntity(outEntity, cameraZone, stopMarginHor, stopMarginVer);
 		}
 
 		// Setting current camera zone as LastCameraZone (to prevent entity from getting out when he shouldn't).
@@ -95,6 +118,7 @@ public:
 
 private:
 	sf::View view;
+	sf::Vector2f previousCenter;
 
 	enum class CameraZoneBound
 	{
@@ -117,8 +141,11 @@ private:
 		bool canInitiateTransition = true;
 	};
 
-	std::vector<CameraZone> cameraZones        = {};
-	std::shared_ptr<CameraZone> lastCameraZone = nullptr;
+	std::vector<CameraZone> cameraZones = {};
+	std::optional<CameraZone> lastCameraZone;
+
+	// Reused every tick
+	std::vector<CameraZone> activeCameraZones;
 
 	enum class TransitionKeyType
 	{
@@ -133,36 +160,51 @@ private:
 	const sf::Int64 defaultTransitionDuration     = 1000000;
 	const int slowModifier                        = 3;
 
-	KeyFrameAnimator<TransitionKeyType> transitionAnimator =
-		KeyFrameAnimator<TransitionKeyType>(defaultTransitionDuration, false);
-
-	void setTransition(bool verticalNotHorizontal, float entityCurrentCoord, float entityTargetCoord,
-					   float cameraTargetCoord, bool slow = false)
-	{
-		transitionAnimator.reset();
-		transitionAnimator.clearAllTimelines();
+	// One animator per axis and speed, built up front with their keys at fixed times. Starting a transition only
+	// overwrites the key values in place so crossing a camera zone doesn't allocate
+	std::array<KeyFrameAnimator<TransitionKeyType>, 4> transitionAnimators = {
+		_makeTransitionAnimator(false, false), _makeTransitionAnimator(true, false),
+		_makeTransitionAnimator(false, true), _makeTransitionAnimator(true, true)};
+	size_t activeTransition = 0;
+	std::vector<std::pair<TransitionKeyType, float>> transitionValues;
 
-		transitionAnimator.setDuration(slow ? slowModifier * defaultTransitionDuration : defaultTransitionDuration);
+	static size_t _transitionIndex(bool verticalNotHorizontal, bool slow) { return verticalNotHorizontal + 2 * slow; }
 
-		KeyFrameTimeline entityTimeline;
-		KeyFrameTimeline cameraTimeline;
+	KeyFrameAnimator<TransitionKeyType> _makeTransitionAnimator(bool verticalNotHorizontal, bool slow) const
+	{
+		const sf::Int64 duration = slow ? slowModifier * defaultTransitionDuration : defaultTransitionDuration;
+		const sf::Int64 endPoint = slow ? transitionAnimationEndPoint * slowModifier : transitionAnimationEndPoint;
 
-		entityTimeline.addKeyFrame(transitionAnimationBeginPoint, entityCurrentCoord, false);
+		KeyFrameAnimator<TransitionKeyType> animator(duration, false);
+		for (auto name : {verticalNotHorizontal ? TransitionKeyType::ENTITY_Y : TransitionKeyType::ENTITY_X,
+						  verticalNotHorizontal ? TransitionKeyType::CAMERA_Y : TransitionKeyType::CAMERA_X})
+		{
+			animator.addKeyToKeyFrameTimeline(name, transitionAnimationBeginPoint, 0.f, false);
+			animator.addKeyToKeyFrameTimeline(name, endPoint, 0.f, true);
+		}
 
-		entityTimeline.addKeyFrame(slow ? transitionAnimationEndPoint * slowModifier : transitionAnimationEndPoint,
-								   entityTargetCoord, true);
+		animator.lock();
+		return animator;
+	}
 
-		cameraTimeline.addKeyFrame(transitionAnimationBeginPoint,
-								   verticalNotHorizontal ? view.getCenter().y : view.getCenter().x, false);
+	void setTransition(bool verticalNotHorizontal, float entityCurrentCoord, float entityTargetCoord,
+					   float cameraTargetCoord, bool slow = false)
+	{
+		activeTransition = _transitionIndex(verticalNotHorizontal, slow);
+		auto& animator   = transitionAnimators[activeTransition];
 
-		cameraTimeline.addKeyFrame(slow ? transitionAnimationEndPoint * slowModifier : transitionAnimationEndPoint,
-								   cameraTargetCoord, true);
+		const auto entityName    = verticalNotHorizontal ? TransitionKeyType::ENTITY_Y : TransitionKeyType::ENTITY_X;
+		const auto cameraName    = verticalNotHorizontal ? TransitionKeyType::CAMERA_Y : TransitionKeyType::CAMERA_X;
+		const sf::Int64 endPoint = slow ? transitionAnimationEndPoint * slowModifier : transitionAnimationEndPoint;
 
-		transitionAnimator.addKeyFrameTimeline(
-			verticalNotHorizontal ? TransitionKeyType::ENTITY_Y : TransitionKeyType::ENTITY_X, entityTimeline);
+		// Same times as the keys already there, so these replace values instead of inserting
+		animator.addKeyToKeyFrameTimeline(entityName, transitionAnimationBeginPoint, entityCurrentCoord, false);
+		animator.addKeyToKeyFrameTimeline(entityName, endPoint, entityTargetCoord, true);
+		animator.addKeyToKeyFrameTimeline(cameraName, transitionAnimationBeginPoint,
+										  verticalNotHorizontal ? view.getCenter().y : view.getCenter().x, false);
+		animator.addKeyToKeyFrameTimeline(cameraName, endPoint, cameraTargetCoord, true);
 
-		transitionAnimator.addKeyFrameTimeline(
-			verticalNotHorizontal ? TransitionKeyType::CAMERA_Y : TransitionKeyType::CAMERA_X, cameraTimeline);
+		animator.reset(transitionValues);
 	}
 
 	void handleRestrictView(const CameraZone& zone)
@@ -1,37 +1,109 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <memory>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "Tracing.hpp"
 #include "Vector2Functions.hpp"
 
 template <typename T>
 class ChunkMap
 {
 public:
+	using Chunk = std::vector<std::shared_ptr<T>>;
+
 	explicit ChunkMap(const sf::Vector2f& chunkSize = sf::Vector2f(16, 16)) : chunkSize(chunkSize){};
 	~ChunkMap() = default;
 
 	// Overload [] operator
-	std::vector<std::shared_ptr<T>>& operator[](const sf::Vector2i& index) { return chunkMap[index]; }
+	Chunk& operator[](const sf::Vector2i& index)
+	{
+		sharedValues = true;
+		return _accessChunk(index);
+	}
 
 	void insertNewValue(const sf::Vector2i& chunk, const T& val)
 	{
-		chunkMap[chunk].push_back(std::make_shared<T>(val));
+		_accessChunk(chunk).push_back(std::make_shared<T>(val));
+	}
+	void insertNewValue(const sf::Vector2i& chunk, T&& val)
+	{
+		_accessChunk(chunk).push_back(std::make_shared<T>(std::move(val)));
+	}
+	void insertNewValuePointer(const sf::Vector2i& chunk, const std::shared_ptr<T>& p)
+	{
+		sharedValues = true;
+		_accessChunk(chunk).push_back(p);
 	}
-	void insertNewValuePointer(const sf::Vector2i& chunk, const std::shared_ptr<T>& p) { chunkMap[chunk].push_back(p); }
 
 	void insertAuto(const sf::FloatRect& valBounds, const std::shared_ptr<T>& p)
 	{
-		auto chunks = findUnderlyingChunks(valBounds);
+		const auto range = findUnderlyingChunkRange(valBounds);
+
+		if (range.width * range.height > 1)
+			sharedValues = true;
 
 		// Insert p into relevant chunks
-		for (const auto& chunk : chunks)
+		for (int y = range.top; y < range.top + range.height; ++y)
+		{
+			for (int x = range.left; x < range.left + range.width; ++x)
+				_accessChunk({x, y}).push_back(p);
+		}
+	}
+
+	// Switches to flat storage covering chunks from minChunk to maxChunk (inclusive), indexed by
+	// (x - minX) + (y - minY) * width. Lookups inside the bounds never touch the tree, chunks outside
+	// of them are still kept in it.
+	void setBounds(const sf::Vector2i& minChunk, const sf::Vector2i& maxChunk)
+	{
+		auto oldGrid   = std::move(grid);
+		auto oldOrigin = gridOrigin;
+		auto oldSize   = gridSize;
+
+		gridOrigin = minChunk;
+		gridSize   = sf::Vector2i(std::max(maxChunk.x - minChunk.x + 1, 0), std::max(maxChunk.y - minChunk.y + 1, 0));
+		grid       = std::vector<Chunk>(static_cast<size_t>(gridSize.x) * static_cast<size_t>(gridSize.y));
+
+		// Move everything stored so far into its new place
+		for (int y = 0; y < oldSize.y; ++y)
+		{
+			for (int x = 0; x < oldSize.x; ++x)
+			{
+				auto& chunk = oldGrid[x + y * oldSize.x];
+				if (!chunk.empty())
+					_accessChunk(oldOrigin + sf::Vector2i(x, y)) = std::move(chunk);
+			}
+		}
+
+		auto it = chunkMap.begin();
+		while (it != chunkMap.end())
 		{
-			chunkMap[chunk].push_back(p);
+			if (_inBounds(it->first))
+			{
+				grid[_gridIndex(it->first)] = std::move(it->second);
+				it                          = chunkMap.erase(it);
+			}
+			else
+				++it;
 		}
 	}
+	bool isBounded() const { return !grid.empty(); }
+	sf::Vector2i getBoundsMin() const { return gridOrigin; }
+	sf::Vector2i getBoundsSize() const { return gridSize; }
+
+	// Contents of a single chunk, empty if there is nothing there. Doesn't create the chunk.
+	const Chunk& getChunk(const sf::Vector2i& index) const
+	{
+		static const Chunk emptyChunk;
+
+		const auto* chunk = _findChunk(index);
+		return chunk ? *chunk : emptyChunk;
+	}
 
 	std::set<sf::Vector2i, Vector2iCompare> findUnderlyingChunks(const sf::FloatRect& rect)
 	{
@@ -41,28 +113,13 @@ public:
 	static std::set<sf::Vector2i, Vector2iCompare> findUnderlyingChunks(const sf::FloatRect& _rect,
 																		const sf::Vector2f& _chunkSize) noexcept
 	{
-		// Find the corners of the bounding box
-		sf::Vector2f topLeft(_rect.left, _rect.top);
-		sf::Vector2f topRight(_rect.left + _rect.width, _rect.top);
-		sf::Vector2f bottomLeft(_rect.left, _rect.top + _rect.height);
-		sf::Vector2f bottomRight(_rect.left + _rect.width, _rect.top + _rect.height);
-
-		// Find the chunks each corner resides in
-		sf::Vector2i topLeftChunk =
-			sf::Vector2i(static_cast<int>(topLeft.x / _chunkSize.x), static_cast<int>(topLeft.y / _chunkSize.y));
-		sf::Vector2i topRightChunk =
-			sf::Vector2i(static_cast<int>(topRight.x / _chunkSize.x), static_cast<int>(topRight.y / _chunkSize.y));
-		sf::Vector2i bottomLeftChunk =
-			sf::Vector2i(static_cast<int>(bottomLeft.x / _chunkSize.x), static_cast<int>(bottomLeft.y / _chunkSize.y));
-
-		//? sf::Vector2i bottomRightChunk = sf::Vector2i(static_cast<int>(bottomRight.x / _chunkSize.x),
-		//? 											 static_cast<int>(bottomRight.y / _chunkSize.y));
+		const auto range = findUnderlyingChunkRange(_rect, _chunkSize);
 
 		// Find all chunks that the bounding box spans
 		std::set<sf::Vector2i, Vector2iCompare> chunks;
-		for (int x = topLeftChunk.x; x <= topRightChunk.x; ++x)
+		for (int x = range.left; x < range.left + range.width; ++x)
 		{
-			for (int y = topLeftChunk.y; y <= bottomLeftChunk.y; ++y)
+			for (int y = range.top; y < range.top + range.height; ++y)
 			{
 				chunks.insert(sf::Vector2i(x, y));
 			}
@@ -71,6 +128,25 @@ public:
 		return chunks;
 	}
 
+	// Same as findUnderlyingChunks, but returns the spanned chunks as a rectangle of chunk indices
+	// (left, top = first chunk, width, height = chunk count), so nothing has to be allocated.
+	sf::IntRect findUnderlyingChunkRange(const sf::FloatRect& rect) const
+	{
+		return findUnderlyingChunkRange(rect, chunkSize);
+	}
+
+	static sf::IntRect findUnderlyingChunkRange(const sf::FloatRect& _rect, const sf::Vector2f& _chunkSize) noexcept
+	{
+		// Find the chunks the top left and bottom right corners reside in
+		const sf::Vector2i topLeftChunk(static_cast<int>(std::floor(_rect.left / _chunkSize.x)),
+										static_cast<int>(std::floor(_rect.top / _chunkSize.y)));
+		const sf::Vector2i bottomRightChunk(static_cast<int>(std::floor((_rect.left + _rect.width) / _chunkSize.x)),
+											static_cast<int>(std::floor((_rect.top + _rect.height) / _chunkSize.y)));
+
+		return {topLeftChunk.x, topLeftChunk.y, bottomRightChunk.x - topLeftChunk.x + 1,
+				bottomRightChunk.y - topLeftChunk.y + 1};
+	}
+
 	std::set<std::shared_ptr<T>> gatherFromChunks()
 	{
 		auto temp = std::vector<sf::Vector2i>();
@@ -89,34 +165,163 @@ public:
 		return _gatherFromChunks(targets);
 	}
 
+	// Buffer filling versions of gatherFromChunks. outBuffer is cleared and refilled with unique values,
+	// so reusing the same buffer every frame means no allocations once it has grown big enough.
+	void gatherFromChunks(std::vector<T*>& outBuffer) const
+	{
+		TraceZone zone("ChunkMap::gatherFromChunks");
+
+		outBuffer.clear();
+		forEachChunk([&outBuffer](const sf::Vector2i&, const Chunk& chunk) { _appendChunk(chunk, outBuffer); });
+		_removeDuplicates(outBuffer);
+	}
+	template <typename Container>
+	void gatherFromChunks(const Container& targets, std::vector<T*>& outBuffer) const
+	{
+		// If no chunks are specified, everything goes
+		if (targets.empty())
+			return gatherFromChunks(outBuffer);
+
+		TraceZone zone("ChunkMap::gatherFromChunks");
+
+		outBuffer.clear();
+		for (const auto& chunk : targets)
+			_appendChunk(getChunk(chunk), outBuffer);
+		_removeDuplicates(outBuffer);
+	}
+	void gatherFromChunkRange(const sf::IntRect& range, std::vector<T*>& outBuffer) const
+	{
+		TraceZone zone("ChunkMap::gatherFromChunkRange");
+
+		outBuffer.clear();
+		for (int y = range.top; y < range.top + range.height; ++y)
+		{
+			for (int x = range.left; x < range.left + range.width; ++x)
+				_appendChunk(getChunk({x, y}), outBuffer);
+		}
+		_removeDuplicates(outBuffer);
+	}
+
+	// Gathers values from the chunks overlapping rect (for example the camera view) into outBuffer
+	void query(const sf::FloatRect& rect, std::vector<T*>& outBuffer) const
+	{
+		gatherFromChunkRange(findUnderlyingChunkRange(rect), outBuffer);
+	}
+
+	// Calls visitor(T& value) for values in chunks overlapping rect, without gathering them first.
+	// Values inserted into more than one chunk can be visited more than once.
+	template <typename Visitor>
+	void forEachInRect(const sf::FloatRect& rect, Visitor&& visitor) const
+	{
+		const auto range = findUnderlyingChunkRange(rect);
+
+		for (int y = range.top; y < range.top + range.height; ++y)
+		{
+			for (int x = range.left; x < range.left + range.width; ++x)
+			{
+				for (const auto& t : getChunk({x, y}))
+					visitor(*t);
+			}
+		}
+	}
+
+	// Calls function(const sf::Vector2i& index, const Chunk& chunk) for every non empty chunk
+	template <typename Function>
+	void forEachChunk(Function&& function) const
+	{
+		for (int y = 0; y < gridSize.y; ++y)
+		{
+			for (int x = 0; x < gridSize.x; ++x)
+			{
+				const auto& chunk = grid[x + y * gridSize.x];
+				if (!chunk.empty())
+					function(gridOrigin + sf::Vector2i(x, y), chunk);
+			}
+		}
+		for (const auto& pair : chunkMap)
+		{
+			if (!pair.second.empty())
+				function(pair.first, pair.second);
+		}
+	}
+
 	sf::Vector2f getChunkSize() const { return chunkSize; }
 	void setChunkSize(const sf::Vector2f& val) { chunkSize = val; }
 
-	std::map<sf::Vector2i, std::vector<std::shared_ptr<T>>, Vector2iCompare>& accessMap() { return chunkMap; }
+	// Chunks kept in the tree, which when bounded are only the ones outside of the bounds
+	std::map<sf::Vector2i, Chunk, Vector2iCompare>& accessMap() { return chunkMap; }
 
 private:
-	std::map<sf::Vector2i, std::vector<std::shared_ptr<T>>, Vector2iCompare> chunkMap;
+	std::map<sf::Vector2i, Chunk, Vector2iCompare> chunkMap;
 	sf::Vector2f chunkSize;
 
+	std::vector<Chunk> grid;
+	sf::Vector2i gridOrigin = sf::Vector2i(0, 0);
+	sf::Vector2i gridSize   = sf::Vector2i(0, 0);
+
+	// Set once the same value could have ended up in more than one chunk
+	bool sharedValues = false;
+
+	bool _inBounds(const sf::Vector2i& index) const
+	{
+		return index.x >= gridOrigin.x && index.y >= gridOrigin.y && index.x < gridOrigin.x + gridSize.x &&
+			   index.y < gridOrigin.y + gridSize.y;
+	}
+	size_t _gridIndex(const sf::Vector2i& index) const
+	{
+		return static_cast<size_t>(index.x - gridOrigin.x) +
+			   static_cast<size_t>(index.y - gridOrigin.y) * static_cast<size_t>(gridSize.x);
+	}
+
+	Chunk& _accessChunk(const sf::Vector2i& index)
+	{
+		if (_inBounds(index))
+			return grid[_gridIndex(index)];
+		return chunkMap[index];
+	}
+	const Chunk* _findChunk(const sf::Vector2i& index) const
+	{
+		if (_inBounds(index))
+			return &grid[_gridIndex(index)];
+		if (chunkMap.empty())
+			return nullptr;
+
+		auto it = chunkMap.find(index);
+		return it != chunkMap.end() ? &it->second : nullptr;
+	}
+
+	static void _appendChunk(const Chunk& chunk, std::vector<T*>& outBuffer)
+	{
+		for (const auto& t : chunk)
+			outBuffer.push_back(t.get());
+	}
+	void _removeDuplicates(std::vector<T*>& outBuffer) const
+	{
+		if (!sharedValues)
+			return;
+
+		std::sort(outBuffer.begin(), outBuffer.end());
+		outBuffer.erase(std::unique(outBuffer.begin(), outBuffer.end()), outBuffer.end());
+	}
+
 	template <typename Container>
 	std::set<std::shared_ptr<T>> _gatherFromChunks(const Container& targets)
 	{
+		TraceZone zone("ChunkMap::gatherFromChunks");
+
 		auto toRet = std::set<std::shared_ptr<T>>();
 
 		// If no chunks are specified, everything goes
 		if (targets.empty())
 		{
-			for (const auto& pair : chunkMap)
-			{
-				for (const auto& t : chunkMap[pair.first])
-					toRet.insert(t);
-			}
+			forEachChunk([&toRet](const sf::Vector2i&, const Chunk& chunk)
+						 { toRet.insert(chunk.begin(), chunk.end()); });
 		}
 		else
 		{
 			for (const auto& chunk : targets)
 			{
-				for (const auto& t : chunkMap[chunk])
+				for (const auto& t : getChunk(chunk))
 					toRet.insert(t);
 			}
 		}
@@ -1,37 +1,28 @@
 #pragma once
 
-#include "GravityEntity.hpp"
+#include "AnimationCrowd.hpp"
 #include "MaskArea2D.hpp"
 
-class Collectable : public GravityEntity
+// Something the player picks up by touching its collect area. It has no sprite of its own, collectables are
+// drawn as instances of an AnimationCrowd (coins by Level::CoinSprites), so each one is just its area and handle.
+class Collectable
 {
 public:
-	explicit Collectable(const sf::Vector2f& position, uint32_t mask, const sf::Vector2f& size = {16.f, 16.f},
-						 const AnimatedSprite& sprite = AnimatedSprite())
-		: GravityEntity(position, 0.f, 0.f), collectArea(position, size, mask)
+	explicit Collectable(const sf::Vector2f& position, uint32_t mask, const sf::Vector2f& size = {16.f, 16.f})
+		: collectArea(position, size, mask)
 	{
-		this->sprite = sprite;
-		this->sprite.setPosition(position);
 	}
 
-	void process(sf::Int64 delta) override
-	{
-		move(sf::Vector2f(moveVector.x * DELTA_CORRECTION, moveVector.y * DELTA_CORRECTION));
-	}
-
-	void setPosition(const sf::Vector2f& val) override
-	{
-		this->GravityEntity::setPosition(val);
-		collectArea.setPosition(val);
-	}
-	void move(const sf::Vector2f& offset) override
-	{
-		this->GravityEntity::move(offset);
-		collectArea.move(offset);
-	}
+	void setPosition(const sf::Vector2f& val) { collectArea.setPosition(val); }
+	void move(const sf::Vector2f& offset) { collectArea.move(offset); }
+	sf::Vector2f getPosition() const { return collectArea.getPosition(); }
 
 	MaskArea2D& accessCollectArea() { return collectArea; }
 
+	void setCrowdHandle(AnimationCrowd::Handle val) { crowdHandle = val; }
+	AnimationCrowd::Handle getCrowdHandle() const { return crowdHandle; }
+
 private:
 	MaskArea2D collectArea;
+	AnimationCrowd::Handle crowdHandle = AnimationCrowd::invalidHandle;
 };
\ No newline at end of file
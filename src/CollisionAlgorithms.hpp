@@ -1,13 +1,19 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <deque>
 #include <memory>
+#include <vector>
 
 #include "ChunkMap.hpp"
 #include "ColliderEntity.hpp"
+#include "CollisionGrid.hpp"
 #include "CollisionBody.hpp"
 #include "StaticTile.hpp"
+#include "Tracing.hpp"
 #include "Vector2Functions.hpp"
 
 class CollisionAlgorithms
@@ -23,14 +29,217 @@ public:
 	CollisionAlgorithms &operator=(CollisionAlgorithms &&) = delete;
 	CollisionAlgorithms &operator=(const CollisionAlgorithms &) = delete;
 
+	// Checks only the chunks under the entity's swept collider (where it is now and where it was one
+	// move vector ago), so the cost doesn't depend on the size of the level.
+	sf::Vector2f AABBWithStaticBodiesCollisionCheck(ChunkMap<StaticTile> &outCollision, ColliderEntity &outEntity)
+	{
+		TraceZone zone("AABBWithStaticBodiesCollisionCheck");
+
+		const auto sweptBounds = _getSweptBounds(outEntity.accessCollider().getRect(), -outEntity.getMoveVector());
+
+		outCollision.gatherFromChunkRange(outCollision.findUnderlyingChunkRange(sweptBounds), staticBodies);
+
+		return _staticBodiesCollision(outEntity);
+	}
+
+	// Checks the given chunks, or every chunk when none are given.
 	sf::Vector2f AABBWithStaticBodiesCollisionCheck(ChunkMap<StaticTile> &outCollision, ColliderEntity &outEntity,
 													const std::set<sf::Vector2i, Vector2iCompare> &chunks)
 	{
-		auto set = outCollision.gatherFromChunks(chunks);
+		TraceZone zone("AABBWithStaticBodiesCollisionCheck");
 
-		std::vector<sf::Vector2f> orientedOverlapVectors;
+		outCollision.gatherFromChunks(chunks, staticBodies);
 
-		for (auto &cb : set)
+		return _staticBodiesCollision(outEntity);
+	}
+
+	// Same resolution as AABBWithStaticBodiesCollisionCheck, but against a bit grid of solid tiles,
+	// looking only at the tiles under the collider.
+	sf::Vector2f AABBWithCollisionGridCheck(const CollisionGrid &solidTiles, ColliderEntity &outEntity)
+	{
+		const auto bounds = outEntity.accessCollider().getRect();
+		const auto tiles  = solidTiles.findUnderlyingTiles(bounds);
+
+		orientedOverlapVectors.clear();
+
+		auto addOverlap = [this, &bounds, &solidTiles](int tileX, int tileY)
+		{
+			sf::Vector2f overlapVector;
+			if (_getOverlapVectorOriented(bounds, solidTiles.getTileRect(tileX, tileY), overlapVector))
+				orientedOverlapVectors.push_back(overlapVector);
+		};
+
+		for (int y = tiles.top; y < tiles.top + tiles.height; ++y)
+			solidTiles.forEachSolidInRow(y, tiles.left, tiles.left + tiles.width - 1, addOverlap);
+
+		return _ejectionFromOverlapVectors();
+	}
+
+	// Continuous collision. Takes the displacement the entity has just been moved by, sweeps its collider
+	// along it from where it started and stops at the first static body hit (sliding along it with what's
+	// left of the displacement), so no amount of movement can pass through a body. Returns the vector
+	// that moves the entity from where it is now to where the sweep ended.
+	sf::Vector2f AABBSweptStaticBodiesCheck(ChunkMap<StaticTile> &outCollision, ColliderEntity &outEntity,
+											const sf::Vector2f &displacement)
+	{
+		const auto end   = outEntity.accessCollider().getRect();
+		const auto start = sf::FloatRect(end.left - displacement.x, end.top - displacement.y, end.width, end.height);
+
+		outCollision.gatherFromChunkRange(outCollision.findUnderlyingChunkRange(_getSweptBounds(end, -displacement)),
+										  staticBodies);
+
+		sweptCandidates.clear();
+		for (auto *cb : staticBodies)
+			sweptCandidates.push_back(cb->getRect());
+
+		return _sweep(start, displacement) - sf::Vector2f(end.left, end.top);
+	}
+
+	// AABBSweptStaticBodiesCheck against a bit grid of solid tiles
+	sf::Vector2f AABBSweptCollisionGridCheck(const CollisionGrid &solidTiles, ColliderEntity &outEntity,
+											 const sf::Vector2f &displacement)
+	{
+		const auto end   = outEntity.accessCollider().getRect();
+		const auto start = sf::FloatRect(end.left - displacement.x, end.top - displacement.y, end.width, end.height);
+		const auto tiles = solidTiles.findUnderlyingTiles(_getSweptBounds(end, -displacement));
+
+		sweptCandidates.clear();
+
+		auto addCandidate = [this, &solidTiles](int tileX, int tileY)
+		{ sweptCandidates.push_back(solidTiles.getTileRect(tileX, tileY)); };
+
+		for (int y = tiles.top; y < tiles.top + tiles.height; ++y)
+			solidTiles.forEachSolidInRow(y, tiles.left, tiles.left + tiles.width - 1, addCandidate);
+
+		return _sweep(start, displacement) - sf::Vector2f(end.left, end.top);
+	}
+
+private:
+	// Sized for a crowded screen up front so the first busy frame doesn't have to grow them
+	CollisionAlgorithms()
+	{
+		staticBodies.reserve(initialBufferSize);
+		orientedOverlapVectors.reserve(initialBufferSize);
+		sweptCandidates.reserve(initialBufferSize);
+	}
+
+	static constexpr size_t initialBufferSize = 64;
+
+	const float tccTolerance = 2.2f;
+
+	// Reused between calls so checking collision doesn't allocate
+	std::vector<StaticTile *> staticBodies;
+	std::vector<sf::Vector2f> orientedOverlapVectors;
+	std::vector<sf::FloatRect> sweptCandidates;
+
+	// How many times a sweep can hit something and slide along it
+	const int maxSweepIterations = 3;
+
+	// Bounding box of rect and rect moved by offset
+	static sf::FloatRect _getSweptBounds(const sf::FloatRect &rect, const sf::Vector2f &offset)
+	{
+		return {std::min(rect.left, rect.left + offset.x), std::min(rect.top, rect.top + offset.y),
+				rect.width + std::fabs(offset.x), rect.height + std::fabs(offset.y)};
+	}
+
+	// Moves rect by displacement, stopping at sweptCandidates. Returns where rect ended up.
+	sf::Vector2f _sweep(sf::FloatRect rect, sf::Vector2f displacement) const
+	{
+		for (int i = 0; i < maxSweepIterations && displacement != sf::Vector2f(0.f, 0.f); ++i)
+		{
+			float firstHit = 1.f;
+			sf::Vector2f hitNormal(0.f, 0.f);
+
+			for (const auto &other : sweptCandidates)
+			{
+				float timeOfImpact;
+				sf::Vector2f normal;
+				if (_getTimeOfImpact(rect, displacement, other, timeOfImpact, normal) && timeOfImpact < firstHit)
+				{
+					firstHit  = timeOfImpact;
+					hitNormal = normal;
+				}
+			}
+
+			rect.left += displacement.x * firstHit;
+			rect.top += displacement.y * firstHit;
+
+			if (hitNormal == sf::Vector2f(0.f, 0.f))
+				break;
+
+			// Slide along whatever was hit with the rest of the displacement
+			displacement *= 1.f - firstHit;
+			if (hitNormal.x != 0.f)
+				displacement.x = 0.f;
+			else
+				displacement.y = 0.f;
+		}
+
+		return {rect.left, rect.top};
+	}
+
+	// Swept AABB test of rect moving by displacement against other. Only counts hits from the outside,
+	// rects that already overlap at the start are left for the overlap checks to push apart.
+	static bool _getTimeOfImpact(const sf::FloatRect &rect, const sf::Vector2f &displacement,
+								 const sf::FloatRect &other, float &outTime, sf::Vector2f &outNormal)
+	{
+		float entry[2];
+		float exit[2];
+
+		const float rectMin[2]  = {rect.left, rect.top};
+		const float rectMax[2]  = {rect.left + rect.width, rect.top + rect.height};
+		const float otherMin[2] = {other.left, other.top};
+		const float otherMax[2] = {other.left + other.width, other.top + other.height};
+		const float moved[2]    = {displacement.x, displacement.y};
+
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			if (moved[axis] > 0.f)
+			{
+				entry[axis] = (otherMin[axis] - rectMax[axis]) / moved[axis];
+				exit[axis]  = (otherMax[axis] - rectMin[axis]) / moved[axis];
+			}
+			else if (moved[axis] < 0.f)
+			{
+				entry[axis] = (otherMax[axis] - rectMin[axis]) / moved[axis];
+				exit[axis]  = (otherMin[axis] - rectMax[axis]) / moved[axis];
+			}
+			else
+			{
+				// Not moving on this axis, so it has to overlap on it the whole time
+				if (!(rectMin[axis] < otherMax[axis] && otherMin[axis] < rectMax[axis]))
+					return false;
+
+				entry[axis] = -std::numeric_limits<float>::infinity();
+				exit[axis]  = std::numeric_limits<float>::infinity();
+			}
+		}
+
+		const float entryTime = std::max(entry[0], entry[1]);
+		const float exitTime  = std::min(exit[0], exit[1]);
+
+		if (entryTime >= exitTime || entryTime < 0.f || entryTime > 1.f)
+			return false;
+
+		outTime = entryTime;
+
+		// Hitting a corner exactly counts as landing on (or bumping into) it vertically
+		if (entry[0] > entry[1])
+			outNormal = sf::Vector2f(displacement.x > 0.f ? -1.f : 1.f, 0.f);
+		else
+			outNormal = sf::Vector2f(0.f, displacement.y > 0.f ? -1.f : 1.f);
+
+		return true;
+	}
+
+	sf::Vector2f _staticBodiesCollision(ColliderEntity &outEntity)
+	{
+		if (Tracing::Get().isEnabled())
+			Tracing::Get().counter("static bodies checked", (double)staticBodies.size());
+
+		orientedOverlapVectors.clear();
+
+		for (auto *cb : staticBodies)
 		{
 			if (cb->intersects(outEntity.accessCollider()))
 			{
@@ -41,6 +250,31 @@ public:
 				cb->setColor(sf::Color(180, 180, 180, 96));
 		}
 
+		return _ejectionFromOverlapVectors();
+	}
+
+	// Same as CollisionBody::getOverlapVectorOriented, for plain rects. False if they don't intersect.
+	static bool _getOverlapVectorOriented(const sf::FloatRect &self, const sf::FloatRect &other,
+										  sf::Vector2f &outOverlapVector)
+	{
+		outOverlapVector.x =
+			std::min(self.left + self.width, other.left + other.width) - std::max(self.left, other.left);
+		outOverlapVector.y =
+			std::min(self.top + self.height, other.top + other.height) - std::max(self.top, other.top);
+
+		if (outOverlapVector.x <= 0.f || outOverlapVector.y <= 0.f)
+			return false;
+
+		if (self.left + self.width / 2.f < other.left + other.width / 2.f)
+			outOverlapVector.x *= -1.f;
+		if (self.top + self.height / 2.f < other.top + other.height / 2.f)
+			outOverlapVector.y *= -1.f;
+
+		return true;
+	}
+
+	sf::Vector2f _ejectionFromOverlapVectors()
+	{
 		for (auto &first : orientedOverlapVectors)
 		{
 			for (auto &second : orientedOverlapVectors)
@@ -83,9 +317,4 @@ public:
 
 		return ejectionVector;
 	}
-
-private:
-	CollisionAlgorithms() = default;
-
-	const float tccTolerance = 2.2f;
 };
\ No newline at end of file
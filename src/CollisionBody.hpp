@@ -10,13 +10,13 @@ public:
 		: Area2D(position, size, color){};
 	~CollisionBody() = default;
 
-	sf::Vector2f getOverlapVector(CollisionBody& other)
+	sf::Vector2f getOverlapVector(const CollisionBody& other) const
 	{
 		if (!intersects(other))
 			return sf::Vector2f(0, 0);
 
-		const auto selfBounds  = area.getGlobalBounds();
-		const auto otherBounds = other.getRectangleShape().getGlobalBounds();
+		const auto& selfBounds  = rect;
+		const auto& otherBounds = other.getRect();
 
 		float amount_h = std::min(selfBounds.left + selfBounds.width, otherBounds.left + otherBounds.width) -
 						 std::max(selfBounds.left, otherBounds.left);
@@ -26,7 +26,7 @@ public:
 		return {amount_h, amount_v};
 	}
 
-	sf::Vector2f getOverlapVectorOriented(CollisionBody& other)
+	sf::Vector2f getOverlapVectorOriented(const CollisionBody& other) const
 	{
 		auto overlapVector = getOverlapVector(other);
 
@@ -38,7 +38,8 @@ public:
 		return overlapVector;
 	}
 
-	sf::Vector2f getEjectionVector(CollisionBody& other, const sf::Vector2f& overlapVector = sf::Vector2f(0, 0))
+	sf::Vector2f getEjectionVector(const CollisionBody& other,
+								   const sf::Vector2f& overlapVector = sf::Vector2f(0, 0)) const
 	{
 		sf::Vector2f ejectionVector(0, 0);
 
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bit per tile occupancy grid of solid terrain. Rows are stored as 64 bit words, so checking a span of
+// a row takes one mask and compare per 64 tiles, and 10000x10000 tiles fit in about 12 MB.
+class CollisionGrid
+{
+public:
+	CollisionGrid() = default;
+	CollisionGrid(const sf::Vector2i& origin, const sf::Vector2i& size, const sf::Vector2f& tileSize)
+	{
+		create(origin, size, tileSize);
+	}
+	~CollisionGrid() = default;
+
+	// origin and size are in tiles
+	void create(const sf::Vector2i& origin, const sf::Vector2i& size, const sf::Vector2f& tileSize)
+	{
+		this->origin   = origin;
+		this->size     = sf::Vector2i(std::max(size.x, 0), std::max(size.y, 0));
+		this->tileSize = tileSize;
+
+		wordsPerRow = (this->size.x + 63) / 64;
+		words.assign(static_cast<size_t>(wordsPerRow) * static_cast<size_t>(this->size.y), 0);
+	}
+
+	void set(int x, int y, bool solid = true)
+	{
+		if (!_inBounds(x, y))
+			return;
+
+		const auto bit = static_cast<uint64_t>(1) << ((x - origin.x) & 63);
+		auto& word     = words[_wordIndex(x, y)];
+		word           = solid ? (word | bit) : (word & ~bit);
+	}
+
+	bool isSolid(int x, int y) const
+	{
+		if (!_inBounds(x, y))
+			return false;
+		return (words[_wordIndex(x, y)] >> ((x - origin.x) & 63)) & 1;
+	}
+
+	// True if any tile in row y from x0 to x1 (inclusive) is solid
+	bool anySolidInRow(int y, int x0, int x1) const
+	{
+		bool found = false;
+		_forEachWordInRow(y, x0, x1, [&found](uint64_t word, int) { found = found || word != 0; });
+		return found;
+	}
+
+	// Calls function(int x, int y) for every solid tile in row y from x0 to x1 (inclusive)
+	template <typename Function>
+	void forEachSolidInRow(int y, int x0, int x1, Function&& function) const
+	{
+		_forEachWordInRow(y, x0, x1,
+						  [&function, y](uint64_t word, int firstX)
+						  {
+							  while (word)
+							  {
+								  function(firstX + _countTrailingZeros(word), y);
+								  word &= word - 1;
+							  }
+						  });
+	}
+
+	// Tiles a rect overlaps (left, top = first tile, width, height = tile count), touching edges don't count
+	sf::IntRect findUnderlyingTiles(const sf::FloatRect& rect) const
+	{
+		const int x0 = static_cast<int>(std::floor(rect.left / tileSize.x));
+		const int y0 = static_cast<int>(std::floor(rect.top / tileSize.y));
+		const int x1 = static_cast<int>(std::ceil((rect.left + rect.width) / tileSize.x)) - 1;
+		const int y1 = static_cast<int>(std::ceil((rect.top + rect.height) / tileSize.y)) - 1;
+
+		return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+	}
+
+	sf::FloatRect getTileRect(int x, int y) const { return {x * tileSize.x, y * tileSize.y, tileSize.x, tileSize.y}; }
+
+	const sf::Vector2i& getOrigin() const { return origin; }
+	const sf::Vector2i& getSize() const { return size; }
+	const sf::Vector2f& getTileSize() const { return tileSize; }
+	size_t getMemoryUsage() const { return words.size() * sizeof(uint64_t); }
+	bool empty() const { return words.empty(); }
+
+private:
+	sf::Vector2i origin   = sf::Vector2i(0, 0);
+	sf::Vector2i size     = sf::Vector2i(0, 0);
+	sf::Vector2f tileSize = sf::Vector2f(16.f, 16.f);
+
+	int wordsPerRow = 0;
+	std::vector<uint64_t> words;
+
+	bool _inBounds(int x, int y) const
+	{
+		return x >= origin.x && y >= origin.y && x < origin.x + size.x && y < origin.y + size.y;
+	}
+	size_t _wordIndex(int x, int y) const
+	{
+		return static_cast<size_t>(y - origin.y) * static_cast<size_t>(wordsPerRow) +
+			   static_cast<size_t>((x - origin.x) / 64);
+	}
+
+	static int _countTrailingZeros(uint64_t word)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	// Calls function(uint64_t maskedWord, int xOfBit0) for every word covering row y from x0 to x1,
+	// with bits outside of the span cleared
+	template <typename Function>
+	void _forEachWordInRow(int y, int x0, int x1, Function&& function) const
+	{
+		if (y < origin.y || y >= origin.y + size.y)
+			return;
+
+		x0 = std::max(x0, origin.x) - origin.x;
+		x1 = std::min(x1, origin.x + size.x - 1) - origin.x;
+		if (x0 > x1)
+			return;
+
+		const size_t rowStart = static_cast<size_t>(y - origin.y) * static_cast<size_t>(wordsPerRow);
+
+		for (int wordIndex = x0 / 64; wordIndex <= x1 / 64; ++wordIndex)
+		{
+			auto word = words[rowStart + wordIndex];
+
+			if (wordIndex == x0 / 64)
+				word &= ~static_cast<uint64_t>(0) << (x0 & 63);
+			if (wordIndex == x1 / 64 && (x1 & 63) != 63)
+				word &= (static_cast<uint64_t>(1) << ((x1 & 63) + 1)) - 1;
+
+			function(word, origin.x + wordIndex * 64);
+		}
+	}
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "CollisionGrid.hpp"
+#include "GlobalDefines.hpp"
+#include "JobSystem.hpp"
+
+// Goomba-like enemies (walk, fall, turn around at walls) kept as structure of arrays instead of one
+// GravityEntity each, so the systems below run linearly over tightly packed floats and tens of thousands of
+// them stay cheap. An enemy is just its index, removing one moves the last enemy into its place.
+class EnemyStore
+{
+public:
+	EnemyStore()  = default;
+	~EnemyStore() = default;
+
+	// position is the top left corner of the collider
+	size_t spawn(const sf::Vector2f& position, bool walkLeft = true)
+	{
+		positionX.push_back(position.x);
+		positionY.push_back(position.y);
+		previousX.push_back(position.x);
+		previousY.push_back(position.y);
+		velocityX.push_back(walkLeft ? -walkSpeed : walkSpeed);
+		velocityY.push_back(0.f);
+		colliderWidth.push_back(colliderSize.x);
+		colliderHeight.push_back(colliderSize.y);
+		gravityConstant.push_back(D_GRAV_CONSTANT);
+		terminalVelocity.push_back(D_TERMINAL_VEL);
+		// Spread out so they don't all step in sync
+		playhead.push_back((int32_t)((positionX.size() * 7919) % (size_t)animationDuration));
+		flags.push_back(0);
+
+		return positionX.size() - 1;
+	}
+
+	// count enemies spread evenly across the width of solidTiles, dropped from its top edge. Every other one
+	// walks left.
+	void spawnAcross(const CollisionGrid& solidTiles, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		const float left   = solidTiles.getOrigin().x * solidTiles.getTileSize().x;
+		const float top    = solidTiles.getOrigin().y * solidTiles.getTileSize().y;
+		const float width  = solidTiles.getSize().x * solidTiles.getTileSize().x;
+		const float stride = width / (float)count;
+
+		for (size_t i = 0; i < count; ++i)
+			spawn({left + stride * ((float)i + 0.5f), top}, i % 2 == 0);
+	}
+
+	void remove(size_t index)
+	{
+		const size_t last = size() - 1;
+		if (index != last)
+		{
+			positionX[index]        = positionX[last];
+			positionY[index]        = positionY[last];
+			previousX[index]        = previousX[last];
+			previousY[index]        = previousY[last];
+			velocityX[index]        = velocityX[last];
+			velocityY[index]        = velocityY[last];
+			colliderWidth[index]    = colliderWidth[last];
+			colliderHeight[index]   = colliderHeight[last];
+			gravityConstant[index]  = gravityConstant[last];
+			terminalVelocity[index] = terminalVelocity[last];
+			playhead[index]         = playhead[last];
+			flags[index]            = flags[last];
+		}
+
+		positionX.pop_back();
+		positionY.pop_back();
+		previousX.pop_back();
+		previousY.pop_back();
+		velocityX.pop_back();
+		velocityY.pop_back();
+		colliderWidth.pop_back();
+		colliderHeight.pop_back();
+		gravityConstant.pop_back();
+		terminalVelocity.pop_back();
+		playhead.pop_back();
+		flags.pop_back();
+	}
+
+	void clear()
+	{
+		while (!empty())
+			remove(size() - 1);
+	}
+
+	size_t size() const { return positionX.size(); }
+	bool empty() const { return positionX.empty(); }
+
+	sf::FloatRect getCollider(size_t index) const
+	{
+		return {positionX[index], positionY[index], colliderWidth[index], colliderHeight[index]};
+	}
+	bool isOnFloor(size_t index) const { return flags[index] & ON_FLOOR; }
+
+	// One simulation tick of every system
+	void process(sf::Int64 delta, const CollisionGrid& solidTiles)
+	{
+		JobSystem::Get().parallelFor(size(), processGrainSize,
+									 [this, delta, &solidTiles](size_t begin, size_t end)
+									 {
+										 applyGravity(delta, begin, end);
+										 moveAndCollide(delta, solidTiles, begin, end);
+										 animate(delta, begin, end);
+									 });
+
+		removeFallenOut(solidTiles);
+	}
+
+	// For rendering between simulation ticks, call at the start of every tick
+	void savePreviousPositions()
+	{
+		previousX = positionX;
+		previousY = positionY;
+	}
+
+	// Systems below work on enemies from begin up to end
+	void applyGravity(sf::Int64 delta, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			velocityY[i] = std::min(velocityY[i] + gravityConstant[i] * DELTA_CORRECTION, terminalVelocity[i]);
+		}
+	}
+
+	// Moves along x then y, stopping at solid tiles. Walking into a wall turns the enemy around.
+	void moveAndCollide(sf::Int64 delta, const CollisionGrid& solidTiles, size_t begin, size_t end)
+	{
+		const auto tileSize   = solidTiles.getTileSize();
+		const float deltaTime = DELTA_CORRECTION;
+
+		// Hot loops over arrays like these read through local pointers and copies. A store through a byte type
+		// (flags here) may alias anything, so whatever is read through this would be reloaded after each one.
+		float* const posX        = positionX.data();
+		float* const posY        = positionY.data();
+		float* const velX        = velocityX.data();
+		float* const velY        = velocityY.data();
+		const float* const sizeX = colliderWidth.data();
+		const float* const sizeY = colliderHeight.data();
+		uint8_t* const flagBits  = flags.data();
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			const float width  = sizeX[i];
+			const float height = sizeY[i];
+
+			// Horizontal, only the column the leading edge moves into is checked
+			float x        = posX[i] + velX[i] * deltaTime;
+			const int row0 = _firstTile(posY[i], tileSize.y);
+			const int row1 = _lastTile(posY[i] + height, tileSize.y);
+
+			const bool right = velX[i] > 0.f;
+			const int column = right ? _lastTile(x + width, tileSize.x) : _firstTile(x, tileSize.x);
+			if (_anySolidInColumn(solidTiles, column, row0, row1))
+			{
+				x       = right ? column * tileSize.x - width : (column + 1) * tileSize.x;
+				velX[i] = -velX[i];
+			}
+			posX[i] = x;
+
+			// Vertical
+			float y           = posY[i] + velY[i] * deltaTime;
+			const int column0 = _firstTile(x, tileSize.x);
+			const int column1 = _lastTile(x + width, tileSize.x);
+
+			const bool down = velY[i] > 0.f;
+			const int row   = down ? _lastTile(y + height, tileSize.y) : _firstTile(y, tileSize.y);
+			const bool hit  = solidTiles.anySolidInRow(row, column0, column1);
+			if (hit)
+			{
+				y       = down ? row * tileSize.y - height : (row + 1) * tileSize.y;
+				velY[i] = 0.f;
+			}
+			posY[i] = y;
+
+			flagBits[i] = (uint8_t)((flagBits[i] & ~ON_FLOOR) | (hit && down ? ON_FLOOR : 0));
+		}
+	}
+
+	void animate(sf::Int64 delta, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			playhead[i] += (int32_t)delta;
+			if (playhead[i] >= animationDuration)
+				playhead[i] -= animationDuration;
+		}
+	}
+
+	// Enemies that fell below the terrain would fall forever
+	void removeFallenOut(const CollisionGrid& solidTiles)
+	{
+		const auto tileSize = solidTiles.getTileSize();
+		const float bottom  = (float)(solidTiles.getOrigin().y + solidTiles.getSize().y + 4) * tileSize.y;
+
+		for (size_t i = size(); i-- > 0;)
+		{
+			if (positionY[i] > bottom)
+				remove(i);
+		}
+	}
+
+	// Calls function(size_t index) for every enemy whose collider overlaps rect. Removing the enemy being
+	// visited from inside function is fine.
+	template <typename Function>
+	void forEachInRect(const sf::FloatRect& rect, Function&& function)
+	{
+		for (size_t i = size(); i-- > 0;)
+		{
+			if (positionX[i] < rect.left + rect.width && positionX[i] + colliderWidth[i] > rect.left &&
+				positionY[i] < rect.top + rect.height && positionY[i] + colliderHeight[i] > rect.top)
+				function(i);
+		}
+	}
+
+	// Frames are frameSize big and laid out in a row starting at firstFrame in the texture, the sprite is
+	// centered on the collider horizontally and stands on its bottom
+	void setAnimation(const sf::Vector2i& firstFrame, const sf::Vector2i& frameSize, int frameCount,
+					  int32_t duration)
+	{
+		animationFirstFrame = firstFrame;
+		animationFrameSize  = frameSize;
+		animationFrames     = std::max(frameCount, 1);
+		animationDuration   = std::max(duration, 1);
+	}
+
+	// Appends a textured quad for every enemy visible in viewRect, interpolated alpha of the way between the
+	// last two ticks. Enemies face the way they walk.
+	void appendQuads(sf::VertexArray& outVertices, const sf::FloatRect& viewRect, float alpha) const
+	{
+		const float frameWidth  = (float)animationFrameSize.x;
+		const float frameHeight = (float)animationFrameSize.y;
+		const int32_t frameTime = animationDuration / animationFrames;
+
+		const size_t count = size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float x = previousX[i] + (positionX[i] - previousX[i]) * alpha;
+			const float y = previousY[i] + (positionY[i] - previousY[i]) * alpha;
+
+			const float left = x + (colliderWidth[i] - frameWidth) / 2.f;
+			const float top  = y + colliderHeight[i] - frameHeight;
+
+			if (left > viewRect.left + viewRect.width || left + frameWidth < viewRect.left ||
+				top > viewRect.top + viewRect.height || top + frameHeight < viewRect.top)
+				continue;
+
+			const int frame     = std::min(playhead[i] / frameTime, animationFrames - 1);
+			const float texLeft = (float)(animationFirstFrame.x + frame * animationFrameSize.x);
+			const float texTop  = (float)animationFirstFrame.y;
+
+			// Sprites face left, walking right mirrors them
+			const float texBegin = velocityX[i] > 0.f ? texLeft + frameWidth : texLeft;
+			const float texEnd   = velocityX[i] > 0.f ? texLeft : texLeft + frameWidth;
+
+			outVertices.append(sf::Vertex({left, top}, {texBegin, texTop}));
+			outVertices.append(sf::Vertex({left + frameWidth, top}, {texEnd, texTop}));
+			outVertices.append(sf::Vertex({left + frameWidth, top + frameHeight}, {texEnd, texTop + frameHeight}));
+			outVertices.append(sf::Vertex({left, top + frameHeight}, {texBegin, texTop + frameHeight}));
+		}
+	}
+
+	void setWalkSpeed(float val) { walkSpeed = val; }
+	void setColliderSize(const sf::Vector2f& val) { colliderSize = val; }
+	const sf::Vector2f& getColliderSize() const { return colliderSize; }
+
+private:
+	enum Flags : uint8_t
+	{
+		ON_FLOOR = 1 << 0,
+	};
+
+	// Enemies per job, small enough to spread a few thousand over all cores, big enough to be worth a job
+	static constexpr size_t processGrainSize = 1024;
+
+	// Used for newly spawned enemies
+	float walkSpeed           = 0.35f;
+	sf::Vector2f colliderSize = sf::Vector2f(14.f, 12.f);
+
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> previousX;
+	std::vector<float> previousY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> colliderWidth;
+	std::vector<float> colliderHeight;
+	std::vector<float> gravityConstant;
+	std::vector<float> terminalVelocity;
+	std::vector<int32_t> playhead;
+	std::vector<uint8_t> flags;
+
+	sf::Vector2i animationFirstFrame = sf::Vector2i(0, 0);
+	sf::Vector2i animationFrameSize  = sf::Vector2i(16, 16);
+	int animationFrames              = 1;
+	int32_t animationDuration        = 300000;
+
+	// Tiles an edge from a to b overlaps, touching doesn't count. Rounds by hand, std::floor and std::ceil are
+	// library calls without SSE4.1 and were most of the cost of moveAndCollide.
+	static int _firstTile(float a, float tileSize)
+	{
+		const float tile = a / tileSize;
+		const int toRet  = (int)tile;
+		return toRet - (tile < (float)toRet);
+	}
+	static int _lastTile(float b, float tileSize)
+	{
+		const float tile = b / tileSize;
+		const int toRet  = (int)tile;
+		return toRet + (tile > (float)toRet) - 1;
+	}
+
+	static bool _anySolidInColumn(const CollisionGrid& solidTiles, int column, int row0, int row1)
+	{
+		for (int row = row0; row <= row1; ++row)
+		{
+			if (solidTiles.isSolid(column, row))
+				return true;
+		}
+		return false;
+	}
+};
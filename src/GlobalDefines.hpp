@@ -4,6 +4,11 @@
 #define D_GRAV_CONSTANT 0.055f
 #define D_TERMINAL_VEL 2.4f
 
+// Simulation runs in fixed ticks of D_TICK_DURATION microseconds, at most D_MAX_CATCH_UP_STEPS per frame
+#define D_TICK_RATE 120
+#define D_TICK_DURATION (1000000 / D_TICK_RATE)
+#define D_MAX_CATCH_UP_STEPS 8
+
 // class Singleton
 // {
 // public:
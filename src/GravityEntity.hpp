@@ -9,9 +9,13 @@
 class GravityEntity
 {
 public:
-	explicit GravityEntity(const sf::Vector2f& position) : position(position) { sprite.setPosition(position); }
+	explicit GravityEntity(const sf::Vector2f& position) : position(position), previousPosition(position)
+	{
+		sprite.setPosition(position);
+	}
 	GravityEntity(const sf::Vector2f& position, float gravityConstant, float terminalVelocity)
-		: position(position), gravityConstant(gravityConstant), terminalVelocity(terminalVelocity)
+		: position(position), previousPosition(position), gravityConstant(gravityConstant),
+		  terminalVelocity(terminalVelocity)
 	{
 		sprite.setPosition(position);
 	}
@@ -24,7 +28,9 @@ public:
 		if (moveVector.y > terminalVelocity)
 			moveVector.y = terminalVelocity;
 
-		move(sf::Vector2f(moveVector.x * DELTA_CORRECTION, moveVector.y * DELTA_CORRECTION));
+		const sf::Vector2f offset(moveVector.x * DELTA_CORRECTION, moveVector.y * DELTA_CORRECTION);
+		displacement += offset;
+		move(offset);
 	}
 
 	virtual void animate(sf::Int64 delta) { sprite.tick(delta); }
@@ -32,12 +38,17 @@ public:
 	virtual void die() { dead = true; }
 
 	void setSpriteTexture(const sf::Texture& texture) { sprite.setTexture(texture); }
+	void setSpriteTexture(const sf::Texture& texture, const sf::Vector2i& regionOffset)
+	{
+		sprite.setTexture(texture, regionOffset);
+	}
 	void setSpriteTextureRect(const sf::IntRect& rect) { sprite.setTextureRect(rect); }
 	void setSpriteOffset(const sf::Vector2f& offset) { sprite.setOffset(offset); }
 	const sf::Sprite& getSprite() { return sprite.get(); }
-	void addAnimation(const std::string& name, const KeyFrameAnimator<AnimatedSprite::KeyType>& animation)
+	AnimatedSprite::AnimationId addAnimation(const std::string& name,
+											 const KeyFrameAnimator<AnimatedSprite::KeyType>& animation)
 	{
-		sprite.addAnimation(name, animation);
+		return sprite.addAnimation(name, animation);
 	}
 	void setSpriteOrigin(const sf::Vector2f& origin) { sprite.setOrigin(origin); }
 
@@ -45,9 +56,21 @@ public:
 	{
 		position = val;
 		sprite.setPosition(val);
+		resetDisplacement();
 	}
 	const sf::Vector2f& getPosition() { return position; }
 
+	// For rendering between simulation ticks, call savePreviousPosition() at the start of every tick
+	void savePreviousPosition() { previousPosition = position; }
+	sf::Vector2f getInterpolatedPosition(float alpha) const
+	{
+		return previousPosition + (position - previousPosition) * alpha;
+	}
+
+	// How far process() has moved the entity since the last reset, teleporting with setPosition resets it
+	const sf::Vector2f& getDisplacement() { return displacement; }
+	void resetDisplacement() { displacement = sf::Vector2f(0, 0); }
+
 	const sf::Vector2f& getMoveVector() { return moveVector; }
 	void setMoveVector(const sf::Vector2f& val) { moveVector = val; }
 
@@ -63,7 +86,9 @@ protected:
 	bool dead = false;
 
 	sf::Vector2f position;
-	sf::Vector2f moveVector = sf::Vector2f(0, 0);
+	sf::Vector2f previousPosition;
+	sf::Vector2f moveVector   = sf::Vector2f(0, 0);
+	sf::Vector2f displacement = sf::Vector2f(0, 0);
 
 	float gravityConstant  = D_GRAV_CONSTANT;
 	float terminalVelocity = D_TERMINAL_VEL;
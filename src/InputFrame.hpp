@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// State of the control keys for one simulation tick, bit i is key i of Controls
+struct InputFrame
+{
+	uint32_t held     = 0;
+	uint32_t pressed  = 0;
+	uint32_t released = 0;
+
+	// Frame where keys only changed between the previous tick and this one
+	static InputFrame fromHeld(uint32_t held, uint32_t previousHeld)
+	{
+		return {held, held & ~previousHeld, ~held & previousHeld};
+	}
+
+	bool operator==(const InputFrame& other) const
+	{
+		return held == other.held && pressed == other.pressed && released == other.released;
+	}
+	bool operator!=(const InputFrame& other) const { return !(*this == other); }
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <SFML/Window.hpp>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "InputFrame.hpp"
+#include "Player.hpp"
+
+// Where the simulation gets its input from, one frame per tick
+class InputSource
+{
+public:
+	virtual ~InputSource() = default;
+
+	virtual InputFrame nextFrame() = 0;
+
+	// True once the source has no more input to give (only ever for replays)
+	virtual bool ended() const { return false; }
+};
+
+// Per tick input, run length encoded since keys are held for many ticks at a time
+class InputLog
+{
+public:
+	struct Run
+	{
+		uint32_t length = 0;
+		InputFrame frame;
+	};
+
+	InputLog()  = default;
+	~InputLog() = default;
+
+	void push(const InputFrame& frame)
+	{
+		if (!runs.empty() && runs.back().frame == frame && runs.back().length < UINT32_MAX)
+			++runs.back().length;
+		else
+			runs.push_back({1, frame});
+
+		++tickCount;
+	}
+
+	void clear()
+	{
+		runs.clear();
+		tickCount = 0;
+	}
+
+	const std::vector<Run>& getRuns() const { return runs; }
+	uint64_t getTickCount() const { return tickCount; }
+
+	// File layout, all little endian: "PFIN", u32 version, u32 run count, then per run u32 length and
+	// u32 held, pressed, released masks
+	bool save(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		file.write(magic, 4);
+		_writeU32(file, version);
+		_writeU32(file, static_cast<uint32_t>(runs.size()));
+
+		for (const auto& run : runs)
+		{
+			_writeU32(file, run.length);
+			_writeU32(file, run.frame.held);
+			_writeU32(file, run.frame.pressed);
+			_writeU32(file, run.frame.released);
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	bool load(const std::string& path)
+	{
+		clear();
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		char fileMagic[4];
+		uint32_t fileVersion = 0;
+		uint32_t runCount    = 0;
+
+		file.read(fileMagic, 4);
+		if (!file || std::string(fileMagic, 4) != std::string(magic, 4) || !_readU32(file, fileVersion) ||
+			fileVersion != version || !_readU32(file, runCount))
+			return false;
+
+		for (uint32_t i = 0; i < runCount; ++i)
+		{
+			Run run;
+			if (!_readU32(file, run.length) || !_readU32(file, run.frame.held) || !_readU32(file, run.frame.pressed) ||
+				!_readU32(file, run.frame.released))
+			{
+				clear();
+				return false;
+			}
+
+			if (run.length == 0)
+				continue;
+
+			runs.push_back(run);
+			tickCount += run.length;
+		}
+
+		return true;
+	}
+
+private:
+	static constexpr const char* magic = "PFIN";
+	static constexpr uint32_t version  = 1;
+
+	std::vector<Run> runs;
+	uint64_t tickCount = 0;
+
+	static void _writeU32(std::ofstream& file, uint32_t val)
+	{
+		const unsigned char bytes[4] = {static_cast<unsigned char>(val), static_cast<unsigned char>(val >> 8),
+										static_cast<unsigned char>(val >> 16), static_cast<unsigned char>(val >> 24)};
+		file.write(reinterpret_cast<const char*>(bytes), 4);
+	}
+	static bool _readU32(std::ifstream& file, uint32_t& outVal)
+	{
+		unsigned char bytes[4];
+		if (!file.read(reinterpret_cast<char*>(bytes), 4))
+			return false;
+
+		outVal = static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+				 static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+		return true;
+	}
+};
+
+// Polls the keyboard for the keys bound in controls
+class KeyboardInputSource : public InputSource
+{
+public:
+	explicit KeyboardInputSource(const Controls& controls) : controls(controls) {}
+
+	InputFrame nextFrame() override
+	{
+		const auto held  = controls.readKeyboard();
+		const auto toRet = InputFrame::fromHeld(held, previousHeld);
+		previousHeld     = held;
+		return toRet;
+	}
+
+private:
+	const Controls& controls;
+	uint32_t previousHeld = 0;
+};
+
+// Builds input from window events instead of polling the keyboard. Every KeyPressed, KeyReleased and
+// LostFocus event has to be passed to handleEvent() with the time it was polled at, SFML events carry no time
+// of their own. A key tapped between two ticks still shows up as pressed and released.
+class EventInputSource : public InputSource
+{
+public:
+	explicit EventInputSource(const Controls& controls) : controls(controls) {}
+
+	void handleEvent(const sf::Event& event, sf::Int64 timestamp)
+	{
+		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
+		{
+			const auto keys = _findKeys(event.key.code);
+			if (keys)
+				events.push_back({timestamp, keys, event.type == sf::Event::KeyPressed});
+		}
+		// Key releases aren't reported to unfocused windows, so everything counts as released
+		else if (event.type == sf::Event::LostFocus)
+			events.push_back({timestamp, UINT32_MAX, false});
+	}
+
+	// Only events polled up to time go into the next frame, the rest waits for later ticks
+	void advanceTo(sf::Int64 time) { frameTime = time; }
+
+	InputFrame nextFrame() override
+	{
+		InputFrame frame;
+
+		size_t consumed = 0;
+		for (; consumed < events.size() && events[consumed].timestamp <= frameTime; ++consumed)
+		{
+			const auto& event = events[consumed];
+
+			if (event.pressed)
+			{
+				// Held keys repeating don't count
+				frame.pressed |= event.keys & ~held;
+				held |= event.keys;
+			}
+			else
+			{
+				frame.released |= event.keys & held;
+				held &= ~event.keys;
+			}
+		}
+		events.erase(events.begin(), events.begin() + consumed);
+
+		frame.held = held;
+		return frame;
+	}
+
+private:
+	struct KeyEvent
+	{
+		sf::Int64 timestamp;
+		uint32_t keys;
+		bool pressed;
+	};
+
+	const Controls& controls;
+
+	std::vector<KeyEvent> events;
+	sf::Int64 frameTime = std::numeric_limits<sf::Int64>::max();
+
+	uint32_t held = 0;
+
+	// Mask of the controls bound to code
+	uint32_t _findKeys(sf::Keyboard::Key code) const
+	{
+		uint32_t keys = 0;
+		for (size_t i = 0; i < controls.getKeyCount(); ++i)
+		{
+			if (controls.getKey(i).keyBind == code)
+				keys |= static_cast<uint32_t>(1) << i;
+		}
+		return keys;
+	}
+};
+
+// Passes input from another source through, keeping a log of it
+class RecordingInputSource : public InputSource
+{
+public:
+	explicit RecordingInputSource(std::unique_ptr<InputSource> source) : source(std::move(source)) {}
+
+	InputFrame nextFrame() override
+	{
+		const auto frame = source->nextFrame();
+		log.push(frame);
+		return frame;
+	}
+	bool ended() const override { return source->ended(); }
+
+	const InputLog& getLog() const { return log; }
+
+private:
+	std::unique_ptr<InputSource> source;
+	InputLog log;
+};
+
+// Plays a log back exactly as it was recorded, then gives empty frames
+class ReplayInputSource : public InputSource
+{
+public:
+	explicit ReplayInputSource(InputLog log) : log(std::move(log)) {}
+
+	InputFrame nextFrame() override
+	{
+		if (ended())
+			return InputFrame();
+
+		const auto& run = log.getRuns()[runIndex];
+		if (++runTick >= run.length)
+		{
+			++runIndex;
+			runTick = 0;
+		}
+		return run.frame;
+	}
+	bool ended() const override { return runIndex >= log.getRuns().size(); }
+
+	const InputLog& getLog() const { return log; }
+
+private:
+	InputLog log;
+
+	size_t runIndex  = 0;
+	uint32_t runTick = 0;
+};
@@ -26,6 +26,12 @@ public:
 	void setInventoryState(const InventoryState& inventoryState_) { inventoryState = inventoryState_; }
 
 	void checkIfCollectedAnything(std::list<Collectable>& outCollectables)
+	{
+		checkIfCollectedAnything(outCollectables, [](const Collectable&) {});
+	}
+	// onCollected(const Collectable&) is called for every collectable right before it's removed
+	template <typename Function>
+	void checkIfCollectedAnything(std::list<Collectable>& outCollectables, Function&& onCollected)
 	{
 		for (auto collectBox : collectBoxes)
 		{
@@ -36,6 +42,7 @@ public:
 					collectBox->intersects(it->accessCollectArea()))
 				{
 					addCoin();
+					onCollected(*it);
 					it = outCollectables.erase(it);
 				}
 				else
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Tracing.hpp"
+
+// Small work stealing thread pool for splitting per tick work over cores. Every worker has its own queue
+// and takes its newest job first, idle workers steal the oldest jobs of the others. The thread that asks
+// for work to be done helps with it until it's finished, so nothing ever waits on an idle core.
+// Jobs point at the caller's function instead of copying it, so queueing work never allocates.
+class JobSystem
+{
+public:
+	static JobSystem& Get()
+	{
+		static JobSystem INSTANCE;
+		return INSTANCE;
+	}
+	JobSystem(JobSystem&&)                 = delete;
+	JobSystem(const JobSystem&)            = delete;
+	JobSystem& operator=(JobSystem&&)      = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// One worker per core next to the main thread
+	static unsigned getDefaultWorkerCount()
+	{
+		const unsigned cores = std::thread::hardware_concurrency();
+		return cores > 1 ? cores - 1 : 0;
+	}
+
+	// Starts workerCount threads, with 0 every job runs right away on the thread asking for it. Call it
+	// while no work is queued.
+	void start(unsigned workerCount)
+	{
+		stop();
+
+		// Queue 0 is shared by every thread that isn't a worker
+		for (unsigned i = 0; i <= workerCount; ++i)
+			queues.push_back(std::make_unique<JobQueue>());
+
+		running = true;
+		for (unsigned i = 1; i <= workerCount; ++i)
+			workers.emplace_back(&JobSystem::_workerLoop, this, (size_t)i);
+	}
+
+	void stop()
+	{
+		if (!workers.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(wakeMutex);
+				running = false;
+			}
+			wake.notify_all();
+
+			for (auto& worker : workers)
+				worker.join();
+			workers.clear();
+		}
+
+		queues.clear();
+	}
+
+	unsigned getWorkerCount() const { return (unsigned)workers.size(); }
+
+	// Calls function(size_t begin, size_t end) for consecutive ranges of at most grainSize indices covering
+	// [0, count) and returns once all of them are done. The ranges only depend on count and grainSize, so as
+	// long as function only writes to what belongs to its own indices the result is the same no matter
+	// which thread ran which range, or how many threads there are. Systems over elements that don't affect
+	// each other, like enemies or animated instances, are spread over all cores this way.
+	template <typename Function>
+	void parallelFor(size_t count, size_t grainSize, Function&& function)
+	{
+		grainSize = std::max(grainSize, (size_t)1);
+
+		if (workers.empty() || count <= grainSize)
+		{
+			if (count > 0)
+				function((size_t)0, count);
+			return;
+		}
+
+		std::atomic<size_t> pending{0};
+
+		Job job;
+		job.invoke  = &_invokeRange<std::remove_reference_t<Function>>;
+		job.context = (void*)&function;
+		job.pending = &pending;
+
+		auto& queue = *queues[_threadIndex()];
+		for (size_t begin = 0; begin < count; begin += grainSize)
+		{
+			job.begin = begin;
+			job.end   = std::min(begin + grainSize, count);
+
+			pending.fetch_add(1, std::memory_order_relaxed);
+			if (!_push(queue, job))
+				_run(job);
+		}
+
+		_wakeWorkers();
+		_waitFor(pending);
+	}
+
+	// Fork/join: run() queues function() to run on any thread, wait() (or the destructor) returns once all of
+	// them have. Functions aren't copied, they have to outlive wait().
+	class TaskGroup
+	{
+	public:
+		TaskGroup() = default;
+		~TaskGroup() { wait(); }
+
+		TaskGroup(const TaskGroup&)            = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		template <typename Function>
+		void run(Function& function)
+		{
+			JobSystem::Get()._fork(function, pending);
+		}
+		template <typename Function>
+		void run(Function&& function) = delete;
+
+		void wait() { JobSystem::Get()._waitFor(pending); }
+
+	private:
+		std::atomic<size_t> pending{0};
+	};
+
+private:
+	struct Job
+	{
+		void (*invoke)(void* context, size_t begin, size_t end) = nullptr;
+		void* context                                           = nullptr;
+		size_t begin                                            = 0;
+		size_t end                                              = 0;
+		std::atomic<size_t>* pending                            = nullptr;
+	};
+
+	// The owner pushes and pops at the back, thieves take from the front
+	class JobQueue
+	{
+	public:
+		bool push(const Job& job)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (count == jobs.size())
+				return false;
+
+			jobs[(first + count) % jobs.size()] = job;
+			++count;
+			return true;
+		}
+
+		bool pop(Job& outJob)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (count == 0)
+				return false;
+
+			--count;
+			outJob = jobs[(first + count) % jobs.size()];
+			return true;
+		}
+
+		bool steal(Job& outJob)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (count == 0)
+				return false;
+
+			outJob = jobs[first];
+			first  = (first + 1) % jobs.size();
+			--count;
+			return true;
+		}
+
+	private:
+		std::mutex mutex;
+		std::array<Job, 1024> jobs;
+		size_t first = 0;
+		size_t count = 0;
+	};
+
+	std::vector<std::unique_ptr<JobQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<bool> running{false};
+	// Jobs sitting in any queue, lets idle workers go to sleep
+	std::atomic<size_t> queuedJobs{0};
+
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+
+	// How long an idle worker keeps looking for jobs before sleeping, long enough to stay awake between the
+	// parallel parts of one tick
+	const std::chrono::microseconds spinTime = std::chrono::microseconds(200);
+
+	JobSystem() = default;
+	~JobSystem() { stop(); }
+
+	// Index of the calling thread's queue
+	static size_t& _threadIndex()
+	{
+		thread_local size_t index = 0;
+		return index;
+	}
+
+	template <typename Function>
+	static void _invokeRange(void* context, size_t begin, size_t end)
+	{
+		(*static_cast<Function*>(context))(begin, end);
+	}
+	template <typename Function>
+	static void _invokeTask(void* context, size_t, size_t)
+	{
+		(*static_cast<Function*>(context))();
+	}
+
+	template <typename Function>
+	void _fork(Function& function, std::atomic<size_t>& pending)
+	{
+		if (workers.empty())
+		{
+			function();
+			return;
+		}
+
+		Job job;
+		job.invoke  = &_invokeTask<Function>;
+		job.context = (void*)&function;
+		job.pending = &pending;
+
+		pending.fetch_add(1, std::memory_order_relaxed);
+		if (!_push(*queues[_threadIndex()], job))
+		{
+			_run(job);
+			return;
+		}
+
+		_wakeWorkers();
+	}
+
+	bool _push(JobQueue& queue, const Job& job)
+	{
+		if (!queue.push(job))
+			return false;
+
+		queuedJobs.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+	// Own queue first, then the others starting from the next one over
+	bool _findJob(size_t index, Job& outJob)
+	{
+		if (queuedJobs.load(std::memory_order_acquire) == 0)
+			return false;
+
+		bool found = queues[index]->pop(outJob);
+		for (size_t i = 1; !found && i < queues.size(); ++i)
+			found = queues[(index + i) % queues.size()]->steal(outJob);
+
+		if (found)
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		return found;
+	}
+
+	void _run(const Job& job)
+	{
+		{
+			TraceZone zone("JobSystem::job");
+			job.invoke(job.context, job.begin, job.end);
+		}
+		job.pending->fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void _wakeWorkers()
+	{
+		// Taking the lock orders this with a worker checking queuedJobs right before going to sleep
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wake.notify_all();
+	}
+
+	// Helps out with whatever is queued until everything counted by pending is done
+	void _waitFor(std::atomic<size_t>& pending)
+	{
+		const size_t index = _threadIndex();
+
+		Job job;
+		while (pending.load(std::memory_order_acquire) > 0)
+		{
+			if (_findJob(index, job))
+				_run(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void _workerLoop(size_t index)
+	{
+		_threadIndex() = index;
+
+		Job job;
+		auto lastJob = std::chrono::steady_clock::now();
+		while (running)
+		{
+			if (_findJob(index, job))
+			{
+				_run(job);
+				lastJob = std::chrono::steady_clock::now();
+				continue;
+			}
+
+			if (std::chrono::steady_clock::now() - lastJob < spinTime)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wake.wait(lock, [this]() { return !running || queuedJobs.load(std::memory_order_acquire) > 0; });
+			lastJob = std::chrono::steady_clock::now();
+		}
+	}
+};
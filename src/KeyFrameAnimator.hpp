@@ -1,8 +1,9 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <memory>
-#include <string>
 #include <utility>
 #include <vector>
 
@@ -14,149 +15,336 @@ struct KeyFrame
 	KeyFrame(float targetValue, bool continuous = false) : targetValue(targetValue), continuous(continuous) {}
 };
 
+// Keys of one animated value, kept sorted by time in one contiguous array. Following the timeline forward
+// only needs a cursor, how many keys have been passed already, so advancing is amortized O(1) per tick
+// instead of a scan from the first key. Cursors belong to whoever plays the timeline, not to the timeline.
 class KeyFrameTimeline
 {
 public:
+	struct Key
+	{
+		int time          = 0;
+		float targetValue = 0.f;
+		bool continuous   = false;
+	};
+
 	KeyFrameTimeline()  = default;
 	~KeyFrameTimeline() = default;
 
-	void addKeyFrame(int when, const std::shared_ptr<KeyFrame>& keyFrame) { timeline[when] = keyFrame; }
+	// A key at the same time as an existing one replaces it
+	void addKeyFrame(int when, const KeyFrame& keyFrame)
+	{
+		auto it = std::lower_bound(keys.begin(), keys.end(), when,
+								   [](const Key& key, int time) { return key.time < time; });
 
+		if (it != keys.end() && it->time == when)
+		{
+			it->targetValue = keyFrame.targetValue;
+			it->continuous  = keyFrame.continuous;
+			return;
+		}
+
+		keys.insert(it, {when, keyFrame.targetValue, keyFrame.continuous});
+	}
 	void addKeyFrame(int when, float keyFrameTargetValue, bool keyFrameContinuous = false)
 	{
-		addKeyFrame(when, std::make_shared<KeyFrame>(KeyFrame(keyFrameTargetValue, keyFrameContinuous)));
+		addKeyFrame(when, KeyFrame(keyFrameTargetValue, keyFrameContinuous));
 	}
 
-	const std::map<int, std::shared_ptr<KeyFrame>>& getTimeline() const { return timeline; }
+	const std::vector<Key>& getKeys() const { return keys; }
 
-	void setLastKeyFrame(int val) { lastKeyFrame = val; }
-	int getLastKeyFrame() const { return lastKeyFrame; }
-	float getLastKeyFrameTargetValue() const
+	// Moves cursor (0 is before the first key) up to elapsedTime. Returns true with the value in outValue when
+	// there is a new one, which is when a key was passed (the latest of them wins) or when the next key is
+	// continuous, then the value is interpolated between the last key and the next one.
+	bool advance(uint32_t& cursor, int elapsedTime, float& outValue) const
 	{
-		try
-		{
-			return timeline.at(lastKeyFrame)->targetValue;
-		} catch (const std::out_of_range&)
+		bool foundAnything = false;
+
+		uint32_t passed = cursor;
+		while (passed < keys.size() && keys[passed].time <= elapsedTime)
+			++passed;
+
+		if (passed > cursor)
 		{
-			return 0.f;
+			cursor        = passed;
+			outValue      = keys[cursor - 1].targetValue;
+			foundAnything = true;
 		}
+
+		if (cursor == 0 || cursor == keys.size() || !keys[cursor].continuous)
+			return foundAnything;
+
+		const Key& last = keys[cursor - 1];
+		const Key& next = keys[cursor];
+
+		outValue = ((float)(elapsedTime - last.time) / (float)(next.time - last.time)) *
+					   (next.targetValue - last.targetValue) +
+				   last.targetValue;
+
+		return true;
 	}
 
 private:
-	std::map<int, std::shared_ptr<KeyFrame>> timeline;
-	int lastKeyFrame = -1;
+	std::vector<Key> keys;
 };
 
+// Where one instance is in a clip. Cursors holds one cursor per timeline of the clip, indexed like them,
+// either a std::vector or a std::array known to be big enough.
+template <typename Cursors>
+struct KeyFramePlayhead
+{
+	int elapsedTime = 0;
+	Cursors cursors = Cursors();
+};
+
+// Timelines of an animation, sorted by name. A clip holds no playback state, so once built it can be shared
+// (as std::shared_ptr<const KeyFrameClip>) by any number of instances, each playing it with its own playhead.
 template <typename T>
-class KeyFrameAnimator
+class KeyFrameClip
 {
 public:
-	KeyFrameAnimator(int duration = 1000000, bool loop = true) : duration(duration), loop(loop) {}
-	~KeyFrameAnimator() = default;
+	KeyFrameClip(int duration = 1000000, bool loop = true) : duration(duration), loop(loop) {}
+	~KeyFrameClip() = default;
 
 	void setDuration(int val) { duration = val; }
 	int getDuration() const { return duration; }
 
-	void addKeyFrameTimeline(const T& name, const KeyFrameTimeline& timeline) { timelines[name] = timeline; }
+	void setLoop(bool val) { loop = val; }
+	bool getLoop() const { return loop; }
 
-	void addKeyToKeyFrameTimeline(const T& timeLineName, int when, const std::shared_ptr<KeyFrame>& keyFrame)
-	{
-		if (!timelines.count(timeLineName))
-			addKeyFrameTimeline(timeLineName, KeyFrameTimeline());
+	void addKeyFrameTimeline(const T& name, const KeyFrameTimeline& timeline) { _accessTimeline(name) = timeline; }
 
-		timelines[timeLineName].addKeyFrame(when, keyFrame);
+	void addKeyToKeyFrameTimeline(const T& timeLineName, int when, const KeyFrame& keyFrame)
+	{
+		_accessTimeline(timeLineName).addKeyFrame(when, keyFrame);
 	}
 	void addKeyToKeyFrameTimeline(const T& timeLineName, int when, float keyFrameTargetValue,
 								  bool keyFrameContinuous = false)
 	{
-		addKeyToKeyFrameTimeline(timeLineName, when,
-								 std::make_shared<KeyFrame>(KeyFrame(keyFrameTargetValue, keyFrameContinuous)));
+		addKeyToKeyFrameTimeline(timeLineName, when, KeyFrame(keyFrameTargetValue, keyFrameContinuous));
 	}
 
 	void clearAllTimelines() { timelines.clear(); }
 
-	std::vector<std::pair<T, float>> reset(bool soft = false)
+	const std::vector<std::pair<T, KeyFrameTimeline>>& getTimelines() const { return timelines; }
+
+	// visitor(const T& name, float value) is called for every timeline with a new value, in order of name
+	template <typename Cursors, typename Visitor>
+	void reset(KeyFramePlayhead<Cursors>& playhead, Visitor&& visitor, bool soft = false) const
 	{
-		elapsedTime = soft ? (elapsedTime - duration) : 0;
-		for (auto&& timeline : timelines)
-			timeline.second.setLastKeyFrame(-1);
+		playhead.elapsedTime = soft ? (playhead.elapsedTime - duration) : 0;
+		_rewind(playhead);
 
-		return tick(0);
+		tick(playhead, 0, visitor);
 	}
 
-	bool ended() const { return elapsedTime >= duration; }
-	void lock() { elapsedTime = duration; }
-
-	std::vector<std::pair<T, float>> tick(int delta)
+	template <typename Cursors>
+	bool ended(const KeyFramePlayhead<Cursors>& playhead) const
 	{
-		std::vector<std::pair<T, float>> toRet;
+		return playhead.elapsedTime >= duration;
+	}
 
-		if (ended())
+	template <typename Cursors, typename Visitor>
+	void tick(KeyFramePlayhead<Cursors>& playhead, int delta, Visitor&& visitor) const
+	{
+		if (ended(playhead))
 		{
-			if (loop)
-				return reset(true);
+			if (!loop)
+				return;
 
-			return toRet;
+			// Back to the start, as many times as it takes when the time overshot by more than a loop
+			do
+			{
+				playhead.elapsedTime -= duration;
+				_rewind(playhead);
+			} while (duration > 0 && ended(playhead));
+			delta = 0;
 		}
 
-		elapsedTime += delta;
+		playhead.elapsedTime += delta;
 
-		for (auto&& timeline : timelines)
-		{
-			std::pair<T, float> p = {T(), 0};
+		const int elapsedTime = playhead.elapsedTime;
+		const size_t count    = timelines.size();
+		const auto* timeline  = timelines.data();
+		uint32_t* cursor      = std::data(playhead.cursors);
 
-			if (_handle_timeline(timeline, p))
-				toRet.push_back(p);
+		float value = 0.f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (timeline[i].second.advance(cursor[i], elapsedTime, value))
+				visitor(timeline[i].first, value);
 		}
-
-		return toRet;
 	}
 
 private:
-	std::map<T, KeyFrameTimeline, std::less<>> timelines;
+	std::vector<std::pair<T, KeyFrameTimeline>> timelines;
 
-	int elapsedTime = 0;
 	int duration;
 	bool loop;
 
-	bool _handle_timeline(std::pair<const T, KeyFrameTimeline>& outTimeline, std::pair<T, float>& outToRet) const
+	KeyFrameTimeline& _accessTimeline(const T& name)
 	{
-		bool foundAnything      = false;
-		bool foundPreviousPoint = false;
+		auto it = std::lower_bound(timelines.begin(), timelines.end(), name,
+								   [](const std::pair<T, KeyFrameTimeline>& timeline, const T& key)
+								   { return timeline.first < key; });
 
-		for (const auto& keyFramePoint : outTimeline.second.getTimeline())
-		{
-			if (keyFramePoint.first <= elapsedTime)
-			{
-				foundPreviousPoint = true;
-
-				if (keyFramePoint.first > outTimeline.second.getLastKeyFrame())
-				{
-					outToRet      = {outTimeline.first, keyFramePoint.second->targetValue};
-					foundAnything = true;
-					outTimeline.second.setLastKeyFrame(keyFramePoint.first);
-				}
-			}
-			else if (foundPreviousPoint && keyFramePoint.first > elapsedTime)
-			{
-				if (!keyFramePoint.second->continuous)
-					return foundAnything;
+		if (it == timelines.end() || name < it->first)
+			it = timelines.insert(it, {name, KeyFrameTimeline()});
+
+		return it->second;
+	}
 
-				auto keyFrameIntervalTime = (float)(keyFramePoint.first - outTimeline.second.getLastKeyFrame());
-				if (keyFrameIntervalTime <= 0.f)
-					continue;
+	template <typename Cursors>
+	void _rewind(KeyFramePlayhead<Cursors>& playhead) const
+	{
+		for (size_t i = 0; i < timelines.size(); ++i)
+			playhead.cursors[i] = 0;
+	}
+};
+
+// A clip together with one playhead. Copies share the clip until one of them is edited, which then gets a
+// copy of its own, so copying an animator never copies its keys.
+template <typename T>
+class KeyFrameAnimator
+{
+public:
+	KeyFrameAnimator(int duration = 1000000, bool loop = true)
+		: clip(std::make_shared<KeyFrameClip<T>>(duration, loop))
+	{
+	}
+	explicit KeyFrameAnimator(const std::shared_ptr<const KeyFrameClip<T>>& clip)
+		: clip(std::const_pointer_cast<KeyFrameClip<T>>(clip)), ownsClip(false)
+	{
+		playhead.cursors.resize(clip->getTimelines().size());
+	}
+	~KeyFrameAnimator() = default;
 
-				auto midwayVal =
-					((float)(elapsedTime - outTimeline.second.getLastKeyFrame()) / keyFrameIntervalTime) *
-						(keyFramePoint.second->targetValue - outTimeline.second.getLastKeyFrameTargetValue()) +
-					outTimeline.second.getLastKeyFrameTargetValue();
+	std::shared_ptr<const KeyFrameClip<T>> getClip() const { return clip; }
 
-				outToRet = {outTimeline.first, midwayVal};
+	void setDuration(int val) { _editClip().setDuration(val); }
+	int getDuration() const { return clip->getDuration(); }
 
-				return true;
-			}
+	void addKeyFrameTimeline(const T& name, const KeyFrameTimeline& timeline)
+	{
+		_editClip().addKeyFrameTimeline(name, timeline);
+		playhead.cursors[_syncCursors(name)] = 0;
+	}
+
+	void addKeyToKeyFrameTimeline(const T& timeLineName, int when, const KeyFrame& keyFrame)
+	{
+		const size_t keyCount = _keyCount(timeLineName);
+		_editClip().addKeyToKeyFrameTimeline(timeLineName, when, keyFrame);
+
+		const size_t index = _syncCursors(timeLineName);
+		const auto& keys   = clip->getTimelines()[index].second.getKeys();
+
+		// Keys already passed stay passed
+		const size_t position = std::lower_bound(keys.begin(), keys.end(), when,
+												 [](const KeyFrameTimeline::Key& key, int time)
+												 { return key.time < time; }) -
+								keys.begin();
+		if (keys.size() > keyCount && position < playhead.cursors[index])
+			++playhead.cursors[index];
+	}
+	void addKeyToKeyFrameTimeline(const T& timeLineName, int when, float keyFrameTargetValue,
+								  bool keyFrameContinuous = false)
+	{
+		addKeyToKeyFrameTimeline(timeLineName, when, KeyFrame(keyFrameTargetValue, keyFrameContinuous));
+	}
+
+	void clearAllTimelines()
+	{
+		_editClip().clearAllTimelines();
+		playhead.cursors.clear();
+	}
+
+	std::vector<std::pair<T, float>> reset(bool soft = false)
+	{
+		std::vector<std::pair<T, float>> toRet;
+		reset(toRet, soft);
+		return toRet;
+	}
+
+	bool ended() const { return clip->ended(playhead); }
+	void lock() { playhead.elapsedTime = clip->getDuration(); }
+
+	std::vector<std::pair<T, float>> tick(int delta)
+	{
+		std::vector<std::pair<T, float>> toRet;
+		tick(delta, toRet);
+		return toRet;
+	}
+
+	// Buffer filling versions of reset() and tick(), outValues is cleared and refilled so it can be reused
+	// every frame without allocating
+	void reset(std::vector<std::pair<T, float>>& outValues, bool soft = false)
+	{
+		outValues.clear();
+		reset([&outValues](const T& name, float value) { outValues.emplace_back(name, value); }, soft);
+	}
+	void tick(int delta, std::vector<std::pair<T, float>>& outValues)
+	{
+		outValues.clear();
+		tick(delta, [&outValues](const T& name, float value) { outValues.emplace_back(name, value); });
+	}
+
+	// Visitor versions, visitor(const T& name, float value) is called for every timeline with a new value,
+	// in order of name
+	template <typename Visitor>
+	void reset(Visitor&& visitor, bool soft = false)
+	{
+		clip->reset(playhead, visitor, soft);
+	}
+
+	template <typename Visitor>
+	void tick(int delta, Visitor&& visitor)
+	{
+		clip->tick(playhead, delta, visitor);
+	}
+
+private:
+	// Only ever edited through _editClip(), which makes sure no one else sees the edit
+	std::shared_ptr<KeyFrameClip<T>> clip;
+	// False for clips passed in from outside, those are copied before the first edit even when not shared
+	bool ownsClip = true;
+	KeyFramePlayhead<std::vector<uint32_t>> playhead;
+
+	KeyFrameClip<T>& _editClip()
+	{
+		if (!ownsClip || clip.use_count() > 1)
+		{
+			clip     = std::make_shared<KeyFrameClip<T>>(*clip);
+			ownsClip = true;
 		}
 
-		return foundAnything;
+		return *clip;
+	}
+
+	size_t _findTimeline(const T& name) const
+	{
+		const auto& timelines = clip->getTimelines();
+		return std::lower_bound(timelines.begin(), timelines.end(), name,
+								[](const std::pair<T, KeyFrameTimeline>& timeline, const T& key)
+								{ return timeline.first < key; }) -
+			   timelines.begin();
+	}
+
+	size_t _keyCount(const T& name) const
+	{
+		const size_t index = _findTimeline(name);
+		if (index == clip->getTimelines().size() || name < clip->getTimelines()[index].first)
+			return 0;
+
+		return clip->getTimelines()[index].second.getKeys().size();
+	}
+
+	// Gives a timeline that was just added a cursor at its start, returns the timeline's index
+	size_t _syncCursors(const T& name)
+	{
+		const size_t index = _findTimeline(name);
+		if (playhead.cursors.size() < clip->getTimelines().size())
+			playhead.cursors.insert(playhead.cursors.begin() + index, 0);
+
+		return index;
 	}
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include <map>
@@ -8,11 +9,16 @@
 #include <string>
 #include <vector>
 
+#include "AnimationCrowd.hpp"
+#include "Camera.hpp"
 #include "ChunkMap.hpp"
 #include "Collectable.hpp"
+#include "CollisionGrid.hpp"
 #include "CollisionBody.hpp"
+#include "EnemyStore.hpp"
 #include "StaticTile.hpp"
 #include "TMXParser.hpp"
+#include "Tracing.hpp"
 
 class Level
 {
@@ -20,44 +26,97 @@ public:
 	ChunkMap<StaticTile> Collision      = ChunkMap<StaticTile>();
 	ChunkMap<StaticTile> Background     = ChunkMap<StaticTile>();
 	ChunkMap<StaticTile> Foreground     = ChunkMap<StaticTile>();
+	CollisionGrid SolidTiles            = CollisionGrid();
+
+	// What terrain collision should check. Either the tiles of Collision, or when merging collision tiles
+	// the biggest rectangles of solid tiles found in each chunk (which are not meant to be drawn).
+	ChunkMap<StaticTile> CollisionBodies = ChunkMap<StaticTile>();
+
 	std::list<Collectable> Collectables = std::list<Collectable>();
+	// Coins are animated and drawn all at once, every coin in Collectables has an instance here
+	AnimationCrowd CoinSprites = AnimationCrowd();
+	EnemyStore Enemies         = EnemyStore();
 
-	explicit Level(const AnimatedSprite& coinSprite) : coinSprite(coinSprite) {}
+	explicit Level(const AnimatedSprite& coinSprite) { CoinSprites.setSprite(coinSprite); }
 	~Level() = default;
 
 	bool create(const std::string& levelPath, bool print = false)
 	{
+		TraceZone zone("Level::create");
+
 		bool parseError = parser.parse(levelPath, print);
 
 		_handleTileLayers();
 
 		camera.findCameraZones(parser.getMap());
+		_handleEnemyObjects();
 
 		return parseError;
 	}
 
 	Camera& accessCamera() { return camera; }
 
+	// Has to be set before create() to have any effect
+	void setMergeCollisionTiles(bool val) { mergeCollisionTiles = val; }
+	bool getMergeCollisionTiles() const { return mergeCollisionTiles; }
+
 	const sf::Color& getBackgroundColor() { return parser.getMap().bgColor; }
 
 private:
 	TMXParser parser;
 	Camera camera;
 
-	AnimatedSprite coinSprite;
+	bool mergeCollisionTiles = false;
 
-	ChunkMap<StaticTile> _parseTileLayer(const TMXLayer& layer)
+	ChunkMap<StaticTile> _parseTileLayer(const TMXLayer& layer, CollisionGrid* outSolidTiles = nullptr,
+										 ChunkMap<StaticTile>* outMergedBodies = nullptr)
 	{
 		const auto tileWidth  = parser.getMap().tileWidth;
 		const auto tileHeight = parser.getMap().tileHeight;
 
-		const auto chunkWidth  = parser.getMap().editorSettings.chunkWidth;
-		const auto chunkHeight = parser.getMap().editorSettings.chunkHeight;
+		const auto chunkWidth  = _getChunkWidth();
+		const auto chunkHeight = _getChunkHeight();
+
+		auto toRet = ChunkMap<StaticTile>(sf::Vector2f(chunkWidth * tileWidth, chunkHeight * tileHeight));
+
+		// TMX chunks are keyed by their first tile, ChunkMap wants chunk indices
+		if (!layer.chunks.empty())
+		{
+			sf::Vector2i minChunk(layer.chunks.begin()->first.first / chunkWidth,
+								  layer.chunks.begin()->first.second / chunkHeight);
+			sf::Vector2i maxChunk = minChunk;
 
-		auto toRet = ChunkMap<StaticTile>(sf::Vector2f(chunkWidth, chunkHeight));
+			for (const auto& chunk : layer.chunks)
+			{
+				minChunk.x = std::min(minChunk.x, chunk.first.first / chunkWidth);
+				minChunk.y = std::min(minChunk.y, chunk.first.second / chunkHeight);
+				maxChunk.x = std::max(maxChunk.x, chunk.first.first / chunkWidth);
+				maxChunk.y = std::max(maxChunk.y, chunk.first.second / chunkHeight);
+			}
+
+			toRet.setBounds(minChunk, maxChunk);
+
+			if (outSolidTiles)
+			{
+				const auto chunkCount = maxChunk - minChunk + sf::Vector2i(1, 1);
+
+				outSolidTiles->create({minChunk.x * chunkWidth, minChunk.y * chunkHeight},
+									  {chunkCount.x * chunkWidth, chunkCount.y * chunkHeight},
+									  {(float)tileWidth, (float)tileHeight});
+			}
+
+			if (outMergedBodies)
+			{
+				*outMergedBodies = ChunkMap<StaticTile>(toRet.getChunkSize());
+				outMergedBodies->setBounds(minChunk, maxChunk);
+			}
+		}
 
 		for (const auto& chunk : layer.chunks)
 		{
+			if (outMergedBodies)
+				_mergeChunkTiles(chunk.second, {chunk.first.first, chunk.first.second}, *outMergedBodies);
+
 			for (size_t i = 0; i < chunk.second.data.size(); ++i)
 			{
 				for (size_t j = 0; j < chunk.second.data[i].size(); ++j)
@@ -70,16 +129,21 @@ private:
 					const auto position =
 						sf::Vector2f((chunk.first.first + j) * tileWidth, (chunk.first.second + i) * tileHeight);
 
-					const auto currentChunk = sf::Vector2i(chunk.first.first, chunk.first.second);
+					const auto currentChunk =
+						sf::Vector2i(chunk.first.first / chunkWidth, chunk.first.second / chunkHeight);
 
 					if (data < 255)
 					{
 						toRet.insertNewValue(currentChunk,
 											 StaticTile(position, {(float)tileWidth, (float)tileHeight}, data - 1));
+
+						if (outSolidTiles)
+							outSolidTiles->set(chunk.first.first + j, chunk.first.second + i);
 					}
 					else
 					{
-						Collectables.push_back(Collectable(position, 1, {16.f, 16.f}, coinSprite));
+						Collectables.push_back(Collectable(position, 1, {16.f, 16.f}));
+						Collectables.back().setCrowdHandle(CoinSprites.spawn(position));
 					}
 				}
 			}
@@ -88,16 +152,112 @@ private:
 		return toRet;
 	}
 
+	// Greedily covers the solid tiles of a chunk with as few rectangles as it can: grows each rectangle
+	// right as far as possible from its top left tile, then down as long as the whole row below is solid.
+	void _mergeChunkTiles(const TMXChunk& chunk, const sf::Vector2i& firstTile, ChunkMap<StaticTile>& outBodies)
+	{
+		const auto tileWidth  = (float)parser.getMap().tileWidth;
+		const auto tileHeight = (float)parser.getMap().tileHeight;
+
+		const auto chunkIndex = sf::Vector2i(firstTile.x / _getChunkWidth(), firstTile.y / _getChunkHeight());
+
+		const auto rows = chunk.data.size();
+		std::vector<std::vector<bool>> merged(rows);
+		for (size_t i = 0; i < rows; ++i)
+			merged[i].resize(chunk.data[i].size(), false);
+
+		auto isFree = [&chunk, &merged](size_t i, size_t j)
+		{
+			return i < chunk.data.size() && j < chunk.data[i].size() && chunk.data[i][j] > 0 &&
+				   chunk.data[i][j] < 255 && !merged[i][j];
+		};
+
+		for (size_t i = 0; i < rows; ++i)
+		{
+			for (size_t j = 0; j < chunk.data[i].size(); ++j)
+			{
+				if (!isFree(i, j))
+					continue;
+
+				size_t width = 1;
+				while (isFree(i, j + width))
+					++width;
+
+				size_t height = 1;
+				while (true)
+				{
+					bool rowFree = true;
+					for (size_t k = 0; k < width && rowFree; ++k)
+						rowFree = isFree(i + height, j + k);
+
+					if (!rowFree)
+						break;
+					++height;
+				}
+
+				for (size_t y = i; y < i + height; ++y)
+				{
+					for (size_t x = j; x < j + width; ++x)
+						merged[y][x] = true;
+				}
+
+				const auto position = sf::Vector2f((firstTile.x + j) * tileWidth, (firstTile.y + i) * tileHeight);
+				const auto size     = sf::Vector2f(width * tileWidth, height * tileHeight);
+
+				outBodies.insertNewValue(chunkIndex, StaticTile(position, size, chunk.data[i][j] - 1));
+			}
+		}
+	}
+
+	// Tiled uses 16x16 chunks when the map doesn't say otherwise
+	int _getChunkWidth()
+	{
+		const auto chunkWidth = parser.getMap().editorSettings.chunkWidth;
+		return chunkWidth > 0 ? chunkWidth : 16;
+	}
+	int _getChunkHeight()
+	{
+		const auto chunkHeight = parser.getMap().editorSettings.chunkHeight;
+		return chunkHeight > 0 ? chunkHeight : 16;
+	}
+
 	void _handleTileLayers()
 	{
 		for (const auto& layer : parser.getMap().layers)
 		{
 			if (layer.second.name == "Collision")
-				Collision = _parseTileLayer(layer.second);
+			{
+				if (mergeCollisionTiles)
+					Collision = _parseTileLayer(layer.second, &SolidTiles, &CollisionBodies);
+				else
+				{
+					Collision       = _parseTileLayer(layer.second, &SolidTiles);
+					CollisionBodies = Collision;
+				}
+			}
 			else if (layer.second.name == "Background")
 				Background = _parseTileLayer(layer.second);
 			else if (layer.second.name == "Foreground")
 				Foreground = _parseTileLayer(layer.second);
 		}
 	}
+
+	// Enemies are points (x, y = bottom center of the collider) of type Enemy in the Enemies object group
+	void _handleEnemyObjects()
+	{
+		for (const auto& objectGroup : parser.getMap().objectGroups)
+		{
+			if (objectGroup.second.name != "Enemies")
+				continue;
+
+			for (const auto& object : objectGroup.second.objects)
+			{
+				if (object.second.type != "Enemy")
+					continue;
+
+				const auto collider = Enemies.getColliderSize();
+				Enemies.spawn({object.second.x - collider.x / 2.f, object.second.y - collider.y});
+			}
+		}
+	}
 };
\ No newline at end of file
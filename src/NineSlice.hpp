@@ -172,7 +172,15 @@ public:
 		return getDrawable(pos.x, pos.y, size.x, size.y, properties);
 	}
 
-	const sf::Texture& getTexture() { return texture; }
+	// Use a copy of the image placed at regionOffset in another texture (like an atlas) instead of the
+	// loaded one. texture has to outlive the NineSlice.
+	void setTexture(const sf::Texture& texture, const sf::Vector2i& regionOffset)
+	{
+		externalTexture    = &texture;
+		this->regionOffset = regionOffset;
+	}
+
+	const sf::Texture& getTexture() { return externalTexture ? *externalTexture : texture; }
 
 	int getTexLeftWidth() { return texLeftWidth; }
 	int getTexRightWidth() { return texRightWidth; }
@@ -183,6 +191,9 @@ public:
 private:
 	sf::Texture texture;
 	sf::IntRect textureRect;
+
+	const sf::Texture* externalTexture = nullptr;
+	sf::Vector2i regionOffset          = sf::Vector2i(0, 0);
 	sf::IntRect centerSlice;
 
 	int texLeftWidth    = 0;
@@ -193,7 +204,8 @@ private:
 	void addQuad(sf::VertexArray& outDrawable, const sf::Vector2f& pos, const sf::Vector2f& size,
 				 const sf::Vector2f& relativeTexPos, const sf::Vector2f& texSize, const sf::Color& color)
 	{
-		auto texPos = relativeTexPos + sf::Vector2f(textureRect.left, textureRect.top);
+		auto texPos =
+			relativeTexPos + sf::Vector2f(textureRect.left + regionOffset.x, textureRect.top + regionOffset.y);
 
 		outDrawable.append(sf::Vertex(sf::Vector2f(pos.x, pos.y), color, sf::Vector2f(texPos.x, texPos.y)));
 
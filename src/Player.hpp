@@ -3,6 +3,7 @@
 #include <SFML/Graphics.hpp>
 
 #include "HitboxEntity.hpp"
+#include "InputFrame.hpp"
 #include "MaskArea2D.hpp"
 #include "Timer.hpp"
 
@@ -22,27 +23,49 @@ public:
 	Controls()  = default;
 	~Controls() = default;
 
-	void update()
+	void update() { update(readKeyboard()); }
+
+	// Updates key states from a mask of held keys, bit i set means getKey(i) is held
+	void update(uint32_t heldKeys) { update(InputFrame::fromHeld(heldKeys, getHeldKeys())); }
+
+	// Updates key states from a whole frame, which can have a key pressed and released within one tick
+	void update(const InputFrame& frame)
 	{
-		for (auto&& key : arr)
+		for (size_t i = 0; i < arr.size(); ++i)
 		{
-			bool now = sf::Keyboard::isKeyPressed(key.keyBind);
+			auto& key = arr[i];
 
-			if (now && !key.isPressed)
-				key.justPressed = true;
-			else
-				key.justPressed = false;
+			key.isPressed    = (frame.held >> i) & 1;
+			key.justPressed  = (frame.pressed >> i) & 1;
+			key.justReleased = (frame.released >> i) & 1;
+		}
+	}
 
-			if (!now && key.isPressed)
-				key.justReleased = true;
-			else
-				key.justReleased = false;
+	const Key& getKey(uint32_t index) const { return arr[index]; }
+	size_t getKeyCount() const { return arr.size(); }
 
-			key.isPressed = now;
+	uint32_t getHeldKeys() const
+	{
+		uint32_t heldKeys = 0;
+		for (size_t i = 0; i < arr.size(); ++i)
+		{
+			if (arr[i].isPressed)
+				heldKeys |= static_cast<uint32_t>(1) << i;
 		}
+		return heldKeys;
 	}
 
-	const Key& getKey(uint32_t index) const { return arr[index]; }
+	// Mask of the bound keys currently held on the keyboard, for update(uint32_t)
+	uint32_t readKeyboard() const
+	{
+		uint32_t heldKeys = 0;
+		for (size_t i = 0; i < arr.size(); ++i)
+		{
+			if (sf::Keyboard::isKeyPressed(arr[i].keyBind))
+				heldKeys |= static_cast<uint32_t>(1) << i;
+		}
+		return heldKeys;
+	}
 
 private:
 	void _updateKeyStatus()
@@ -73,17 +96,34 @@ private:
 class Player : public ColliderEntity
 {
 public:
+	enum class Animation
+	{
+		STAND = 0,
+		RUN   = 1,
+		JUMP  = 2,
+		FALL  = 3,
+		TURN  = 4,
+		PUSH  = 5,
+	};
+
 	Player(const sf::Vector2f& position, const Controls& controls)
 		: ColliderEntity(position, sf::Vector2f(14.f, 14.f), sf::Vector2f(-7.f, -7.f)),
 		  controls(controls),
 		  collectBox(std::make_shared<MaskArea2D>(MaskArea2D(position - sf::Vector2f(6.f, 18.f), {12.f, 24.f}, 0, 1)))
-	{}
+	{
+		animationIds.fill(AnimatedSprite::noAnimation);
+	}
 	~Player() override = default;
 
-	void process(sf::Int64 delta) override
+	// Animations the player switches between by id, without ever looking them up by name while playing
+	void addAnimation(Animation which, const KeyFrameAnimator<AnimatedSprite::KeyType>& animation)
 	{
-		controls.update();
+		animationIds[(size_t)which] = sprite.addAnimation(animationNames[(size_t)which], animation);
+	}
 
+	// Controls have to be updated before this
+	void process(sf::Int64 delta) override
+	{
 		float horizontalInput = (float)controls.getKey(3).isPressed - (float)controls.getKey(2).isPressed;
 		const bool running    = controls.getKey(5).isPressed;
 
@@ -143,28 +183,28 @@ public:
 		if (coyoteTimer.hasTimedOut())
 		{
 			if (moveVector.y <= 0.f)
-				sprite.setAnimation("Jump");
+				_setAnimation(Animation::JUMP);
 			else
-				sprite.setAnimation("Fall");
+				_setAnimation(Animation::FALL);
 		}
 		else
 		{
 			if (moveVector.x == 0.f)
-				sprite.setAnimation("Stand");
+				_setAnimation(Animation::STAND);
 			else if (horizontalInput == 0.f || (moveVector.x > 0.f && horizontalInput > 0.f) ||
 					 (moveVector.x < 0.f && horizontalInput < 0.f))
 			{
 				if (onRightWall || onLeftWall)
-					sprite.setAnimation("Push", sprite.getCurrentAnimation() != "Push");
+					_setAnimation(Animation::PUSH, true);
 				else
 				{
-					sprite.setAnimation("Run", sprite.getCurrentAnimation() != "Run");
+					_setAnimation(Animation::RUN, true);
 					sprite.setAnimationSpeedMultiplier(1.f + 2.f * (std::fabs(moveVector.x) - walkSpeed));
 				}
 			}
 
 			else
-				sprite.setAnimation("Turn");
+				_setAnimation(Animation::TURN);
 		}
 
 		this->ColliderEntity::process(delta);
@@ -205,11 +245,16 @@ public:
 
 	std::shared_ptr<MaskArea2D> getCollectBox() const { return collectBox; }
 
+	Controls& accessControls() { return controls; }
+
 private:
 	Controls controls;
 
 	std::shared_ptr<MaskArea2D> collectBox;
 
+	static constexpr std::array<const char*, 6> animationNames = {"Stand", "Run", "Jump", "Fall", "Turn", "Push"};
+	std::array<AnimatedSprite::AnimationId, 6> animationIds;
+
 	Timer coyoteTimer = Timer(0.05f);
 
 	int lookDir = 1;
@@ -223,4 +268,11 @@ private:
 	const float acc             = 0.005f;
 	const float deAcc           = 0.015f;
 	const float turnAroundDeAcc = 0.03f;
+
+	// Restarts the animation, unless keepPlaying is set and it's playing already
+	void _setAnimation(Animation which, bool keepPlaying = false)
+	{
+		const AnimatedSprite::AnimationId id = animationIds[(size_t)which];
+		sprite.setAnimation(id, !keepPlaying || sprite.getCurrentAnimation() != id);
+	}
 };
\ No newline at end of file
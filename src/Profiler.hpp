@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "AllocationTracker.hpp"
+#include "RingBuffer.hpp"
+
+// Measures how long each phase of a frame takes. Phases are timed with ProfileZone, endFrame() closes the
+// frame and queues its sample, collect() moves queued samples into the history the overlay and CSV use.
+// Heap allocations are counted alongside when AllocationTracker is enabled.
+class Profiler
+{
+public:
+	enum Phase : size_t
+	{
+		INPUT = 0,
+		PROCESS,
+		COLLISION,
+		ENEMIES,
+		COINS,
+		INVENTORY,
+		CAMERA,
+		TILES,
+		SPRITES,
+		HUD,
+		PHASE_COUNT
+	};
+
+	// Times in microseconds
+	struct FrameSample
+	{
+		uint64_t frame  = 0;
+		float frameTime = 0.f;
+		std::array<float, PHASE_COUNT> phaseTimes{};
+
+		uint32_t allocations    = 0;
+		uint64_t allocatedBytes = 0;
+		std::array<uint32_t, PHASE_COUNT> phaseAllocations{};
+	};
+
+	static Profiler& Get()
+	{
+		static Profiler INSTANCE;
+		return INSTANCE;
+	}
+	Profiler(Profiler&&)                 = delete;
+	Profiler(const Profiler&)            = delete;
+	Profiler& operator=(Profiler&&)      = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	static const char* getPhaseName(size_t phase)
+	{
+		static const std::array<const char*, PHASE_COUNT> names = {
+			"input", "process", "collision", "enemies", "coins", "inventory", "camera", "tiles", "sprites", "hud"};
+		return phase < PHASE_COUNT ? names[phase] : "other";
+	}
+
+	void setEnabled(bool val) { enabled = val; }
+	bool isEnabled() const { return enabled; }
+
+	void addTime(Phase phase, float microseconds) { current.phaseTimes[phase] += microseconds; }
+	void addAllocations(Phase phase, uint64_t allocations) { current.phaseAllocations[phase] += (uint32_t)allocations; }
+
+	void endFrame()
+	{
+		const auto now = std::chrono::steady_clock::now();
+
+		current.frame     = frameCount++;
+		current.frameTime = std::chrono::duration<float, std::micro>(now - frameStart).count();
+		frameStart        = now;
+
+		const auto allocations = AllocationTracker::getCounts() - frameStartAllocations;
+		current.allocations    = (uint32_t)allocations.allocations;
+		current.allocatedBytes = allocations.bytes;
+		frameStartAllocations  = AllocationTracker::getCounts();
+
+		if (enabled)
+			samples.push(current);
+
+		lastFrame = current;
+		current   = FrameSample();
+	}
+
+	// The frame closed by the latest endFrame(), also kept while the profiler is disabled
+	const FrameSample& getLastFrame() const { return lastFrame; }
+
+	// Moves queued samples into the history, oldest samples fall out of it
+	void collect()
+	{
+		FrameSample sample;
+		while (samples.pop(sample))
+		{
+			if (history.size() < historySize)
+				history.push_back(sample);
+			else
+				history[historyNext] = sample;
+
+			historyNext = (historyNext + 1) % historySize;
+		}
+	}
+
+	// Calls function(const FrameSample&) for samples in the history, oldest first
+	template <typename Function>
+	void forEachSample(Function&& function) const
+	{
+		const size_t first = history.size() < historySize ? 0 : historyNext;
+		for (size_t i = 0; i < history.size(); ++i)
+			function(history[(first + i) % history.size()]);
+	}
+	size_t getSampleCount() const { return history.size(); }
+
+	// Frame time (or phase time) below which percentile (0 to 1) of the history falls
+	float getPercentile(float percentile, size_t phase = PHASE_COUNT)
+	{
+		if (history.empty())
+			return 0.f;
+
+		scratch.clear();
+		for (const auto& sample : history)
+			scratch.push_back(phase < PHASE_COUNT ? sample.phaseTimes[phase] : sample.frameTime);
+
+		const auto index = std::min((size_t)(percentile * (float)scratch.size()), scratch.size() - 1);
+		std::nth_element(scratch.begin(), scratch.begin() + index, scratch.end());
+		return scratch[index];
+	}
+
+	bool dumpCsv(const std::string& path) const
+	{
+		std::ofstream file(path);
+		if (!file)
+			return false;
+
+		file << "frame,frame_us";
+		for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+			file << ',' << getPhaseName(phase) << "_us";
+		if (AllocationTracker::ENABLED)
+		{
+			file << ",allocations,allocated_bytes";
+			for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+				file << ',' << getPhaseName(phase) << "_allocations";
+		}
+		file << '\n';
+
+		forEachSample(
+			[&file](const FrameSample& sample)
+			{
+				file << sample.frame << ',' << sample.frameTime;
+				for (const auto time : sample.phaseTimes)
+					file << ',' << time;
+				if (AllocationTracker::ENABLED)
+				{
+					file << ',' << sample.allocations << ',' << sample.allocatedBytes;
+					for (const auto allocations : sample.phaseAllocations)
+						file << ',' << allocations;
+				}
+				file << '\n';
+			});
+
+		return static_cast<bool>(file);
+	}
+
+private:
+	Profiler() = default;
+
+	bool enabled = true;
+
+	FrameSample current;
+	FrameSample lastFrame;
+	uint64_t frameCount = 0;
+
+	std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+	AllocationTracker::Counts frameStartAllocations;
+
+	RingBuffer<FrameSample, 256> samples;
+
+	const size_t historySize = 1024;
+	std::vector<FrameSample> history;
+	size_t historyNext = 0;
+
+	std::vector<float> scratch;
+};
+
+// Adds the time (and allocations) between its construction and destruction to a phase of the current frame
+class ProfileZone
+{
+public:
+	explicit ProfileZone(Profiler::Phase phase)
+		: phase(phase), start(std::chrono::steady_clock::now()), startAllocations(AllocationTracker::getCounts())
+	{}
+	~ProfileZone()
+	{
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		Profiler::Get().addTime(phase, std::chrono::duration<float, std::micro>(elapsed).count());
+
+		if (AllocationTracker::ENABLED)
+			Profiler::Get().addAllocations(
+				phase, AllocationTracker::getCounts().allocations - startAllocations.allocations);
+	}
+
+	ProfileZone(const ProfileZone&)            = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	Profiler::Phase phase;
+	std::chrono::steady_clock::time_point start;
+	AllocationTracker::Counts startAllocations;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+
+#include "BitmapFont.hpp"
+#include "Profiler.hpp"
+
+// Draws the profiler history as a rolling graph of stacked phase times, one column per frame, with frame
+// time percentiles and the most expensive phase written above it. With AllocationTracker enabled the heap
+// allocations of the latest frame are written too.
+class ProfilerOverlay
+{
+public:
+	ProfilerOverlay()  = default;
+	~ProfilerOverlay() = default;
+
+	// area is in the coordinates of the target's current view, its height covers graphRange microseconds
+	void draw(sf::RenderTarget& target, BitmapFont& font, const sf::FloatRect& area)
+	{
+		auto& profiler = Profiler::Get();
+
+		graph.clear();
+		_addQuad(area.left, area.top, area.width, area.height, sf::Color(0, 0, 0, 160));
+
+		// Newest frame on the right
+		const size_t columns = (size_t)area.width;
+		const size_t skipped = profiler.getSampleCount() > columns ? profiler.getSampleCount() - columns : 0;
+		const float scale    = area.height / graphRange;
+		const float bottom   = area.top + area.height;
+
+		size_t index = 0;
+		profiler.forEachSample(
+			[&](const Profiler::FrameSample& sample)
+			{
+				if (index++ < skipped)
+					return;
+
+				const float x = area.left + area.width - (float)(profiler.getSampleCount() - index) - 1.f;
+				float y       = bottom;
+
+				float phasesTotal = 0.f;
+				for (size_t phase = 0; phase < Profiler::PHASE_COUNT; ++phase)
+				{
+					const float height = std::min(sample.phaseTimes[phase] * scale, y - area.top);
+					y -= height;
+					phasesTotal += sample.phaseTimes[phase];
+					_addQuad(x, y, 1.f, height, phaseColors[phase]);
+				}
+
+				// Whatever the phases don't cover (waiting for the display, drawing the debug overlay)
+				const float other = std::min((sample.frameTime - phasesTotal) * scale, y - area.top);
+				if (other > 0.f)
+					_addQuad(x, y - other, 1.f, other, sf::Color(90, 90, 90));
+			});
+
+		target.draw(graph);
+
+		// Text
+		size_t slowestPhase = 0;
+		float slowestTime   = 0.f;
+		for (size_t phase = 0; phase < Profiler::PHASE_COUNT; ++phase)
+		{
+			const float time = profiler.getPercentile(0.95f, phase);
+			if (time > slowestTime)
+			{
+				slowestPhase = phase;
+				slowestTime  = time;
+			}
+		}
+
+		char buffer[192];
+		const int length = std::snprintf(buffer, sizeof(buffer), "p50 %.2f p95 %.2f p99 %.2f ms\n%s p95 %.3f ms",
+										 profiler.getPercentile(0.5f) / 1000.f, profiler.getPercentile(0.95f) / 1000.f,
+										 profiler.getPercentile(0.99f) / 1000.f, Profiler::getPhaseName(slowestPhase),
+										 slowestTime / 1000.f);
+
+		float textTop = area.top - 18.f;
+		if (AllocationTracker::ENABLED && length > 0 && (size_t)length < sizeof(buffer))
+		{
+			const auto& latest = profiler.getLastFrame();
+			const auto mostAllocating =
+				(size_t)(std::max_element(latest.phaseAllocations.begin(), latest.phaseAllocations.end()) -
+						 latest.phaseAllocations.begin());
+
+			std::snprintf(buffer + length, sizeof(buffer) - length, "\nallocs %u (%llu B) %s %u", latest.allocations,
+						  (unsigned long long)latest.allocatedBytes, Profiler::getPhaseName(mostAllocating),
+						  latest.phaseAllocations[mostAllocating]);
+			textTop -= 9.f;
+		}
+
+		// Widened by hand into a reused string, so the overlay itself doesn't allocate every frame
+		text.clear();
+		for (const char* ch = buffer; *ch; ++ch)
+			text.push_back((wchar_t)*ch);
+
+		font.getTextDrawable(textDrawable, text, area.left, textTop);
+		target.draw(textDrawable, &font.getFontTexture());
+	}
+
+	// Frame time the full height of the graph stands for, in microseconds
+	void setGraphRange(float microseconds) { graphRange = microseconds; }
+	float getGraphRange() const { return graphRange; }
+
+private:
+	sf::VertexArray graph = sf::VertexArray(sf::Quads);
+	sf::VertexArray textDrawable;
+	std::wstring text;
+
+	float graphRange = 33333.f;
+
+	const std::array<sf::Color, Profiler::PHASE_COUNT> phaseColors = {
+		sf::Color(230, 230, 80),  sf::Color(80, 200, 80),   sf::Color(230, 80, 80),   sf::Color(150, 90, 40),
+		sf::Color(240, 170, 40),  sf::Color(200, 120, 240), sf::Color(80, 200, 230),  sf::Color(60, 100, 230),
+		sf::Color(240, 120, 180), sf::Color(255, 255, 255)};
+
+	void _addQuad(float x, float y, float width, float height, const sf::Color& color)
+	{
+		graph.append(sf::Vertex(sf::Vector2f(x, y), color));
+		graph.append(sf::Vertex(sf::Vector2f(x + width, y), color));
+		graph.append(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+		graph.append(sf::Vertex(sf::Vector2f(x, y + height), color));
+	}
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock free queue for exactly one producer thread and one consumer thread. Capacity has to be a
+// power of two. push() never blocks, it fails when the buffer is full and the value is dropped.
+template <typename T, size_t Capacity>
+class RingBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity has to be a power of two");
+
+public:
+	RingBuffer()  = default;
+	~RingBuffer() = default;
+
+	RingBuffer(const RingBuffer&)            = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	// Producer side
+	bool push(const T& val)
+	{
+		const auto currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead - tail.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		buffer[currentHead & (Capacity - 1)] = val;
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool pop(T& outVal)
+	{
+		const auto currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail == head.load(std::memory_order_acquire))
+			return false;
+
+		outVal = buffer[currentTail & (Capacity - 1)];
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Only exact when called from one of the two threads while the other one is idle
+	size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+	bool empty() const { return size() == 0; }
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	std::array<T, Capacity> buffer;
+
+	// On separate cache lines so the two threads don't keep stealing them from each other
+	alignas(64) std::atomic<size_t> head{0};
+	alignas(64) std::atomic<size_t> tail{0};
+};
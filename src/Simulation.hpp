@@ -0,0 +1,162 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+#include "CollisionAlgorithms.hpp"
+#include "InputFrame.hpp"
+#include "Inventory.hpp"
+#include "Level.hpp"
+#include "Player.hpp"
+#include "Profiler.hpp"
+
+// Game logic of one simulation tick, kept away from anything that needs a window so it can also run
+// headless. Input comes in as one InputFrame per tick.
+class Simulation
+{
+public:
+	Simulation(Level& level, Player& player, Inventory& inventory)
+		: level(level), player(player), inventory(inventory)
+	{}
+	~Simulation() = default;
+
+	void tick(sf::Int64 delta, const InputFrame& input)
+	{
+		auto& camera = level.accessCamera();
+
+		player.savePreviousPosition();
+		camera.savePreviousView();
+		level.Enemies.savePreviousPositions();
+
+		{
+			ProfileZone zone(Profiler::PROCESS);
+
+			if (!camera.isInTransitionAnimation())
+			{
+				player.accessControls().update(input);
+				player.process(delta);
+			}
+
+			player.animate(delta);
+		}
+
+		{
+			ProfileZone zone(Profiler::COLLISION);
+			_handleTerrainCollision();
+		}
+
+		{
+			ProfileZone zone(Profiler::ENEMIES);
+			if (!camera.isInTransitionAnimation())
+				level.Enemies.process(delta, level.SolidTiles);
+			_handleEnemyStomps();
+		}
+
+		// Coins
+		{
+			ProfileZone zone(Profiler::COINS);
+			level.CoinSprites.tick((int)delta);
+		}
+		{
+			ProfileZone zone(Profiler::INVENTORY);
+			inventory.checkIfCollectedAnything(level.Collectables, [this](const Collectable& coin)
+											   { level.CoinSprites.remove(coin.getCrowdHandle()); });
+		}
+
+		// Camera
+		{
+			ProfileZone zone(Profiler::CAMERA);
+			if (camera.isInTransitionAnimation())
+			{
+				camera.transitionAnimationTick(delta, player);
+			}
+			else
+			{
+				camera.followEntity(player, player.accessCollider().getSize().x / 2.f,
+									player.accessCollider().getSize().y / 2.f);
+			}
+		}
+
+		++tickCount;
+	}
+
+	// Terrain collision against the solid tile bit grid instead of the collision bodies
+	void setGridCollision(bool val) { gridCollision = val; }
+	bool getGridCollision() const { return gridCollision; }
+
+	uint64_t getTickCount() const { return tickCount; }
+
+private:
+	Level& level;
+	Player& player;
+	Inventory& inventory;
+
+	bool gridCollision = false;
+	uint64_t tickCount = 0;
+
+	void _handleTerrainCollision()
+	{
+		auto& collision    = CollisionAlgorithms::Get();
+		auto beforeMoveVec = player.getMoveVector();
+		auto displacement  = player.getDisplacement();
+		player.resetDisplacement();
+
+		// Sweep first so fast movement can't skip over tiles, then push out of anything still overlapping
+		sf::Vector2f sweptVec;
+		if (gridCollision)
+			sweptVec = collision.AABBSweptCollisionGridCheck(level.SolidTiles, player, displacement);
+		else
+			sweptVec = collision.AABBSweptStaticBodiesCheck(level.CollisionBodies, player, displacement);
+
+		player.move(sweptVec);
+
+		sf::Vector2f overlapVec;
+		if (gridCollision)
+			overlapVec = collision.AABBWithCollisionGridCheck(level.SolidTiles, player);
+		else
+			overlapVec = collision.AABBWithStaticBodiesCollisionCheck(level.CollisionBodies, player);
+
+		player.move(overlapVec);
+
+		const auto resVec = sweptVec + overlapVec;
+
+		player.resetOnEverything();
+
+		if (resVec.x * beforeMoveVec.x < 0.f)
+		{
+			player.setMoveVector({0.f, player.getMoveVector().y});
+
+			if (resVec.x > 0.f)
+				player.setOnLeftWall(true);
+			else
+				player.setOnRightWall(true);
+		}
+		if (resVec.y * beforeMoveVec.y < 0.f)
+		{
+			player.setMoveVector({player.getMoveVector().x, 0.f});
+
+			if (resVec.y < 0.f)
+				player.setOnFloor(true);
+			else
+				player.setOnCeil(true);
+		}
+	}
+
+	// Landing on an enemy while falling defeats it and bounces the player off
+	void _handleEnemyStomps()
+	{
+		if (player.getMoveVector().y <= 0.f)
+			return;
+
+		bool stomped = false;
+		level.Enemies.forEachInRect(player.accessCollider().getRect(),
+									[this, &stomped](size_t index)
+									{
+										level.Enemies.remove(index);
+										stomped = true;
+									});
+
+		if (stomped)
+			player.bounceOff();
+	}
+};
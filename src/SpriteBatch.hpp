@@ -0,0 +1,144 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "Tracing.hpp"
+
+// Collects sprites over a frame and draws them with one draw call per texture and layer. Lower layers are
+// drawn first, inside a layer sprites are grouped by texture, so only the layer decides what ends up on top.
+class SpriteBatch
+{
+public:
+	SpriteBatch()  = default;
+	~SpriteBatch() = default;
+
+	// Sprites without a texture are skipped. renderOffset moves the sprite only for this draw.
+	void add(const sf::Sprite& sprite, int layer = 0, const sf::Vector2f& renderOffset = sf::Vector2f(0.f, 0.f))
+	{
+		if (!sprite.getTexture())
+			return;
+
+		sf::Vertex* quad = appendQuads(*sprite.getTexture(), layer, 1);
+
+		const auto& transform = sprite.getTransform();
+		const auto& rect      = sprite.getTextureRect();
+		const auto size       = sf::Vector2f(std::abs(rect.width), std::abs(rect.height));
+
+		// Negative texture rect sizes flip the sprite, same as with sf::Sprite
+		const float texLeft   = static_cast<float>(rect.left);
+		const float texTop    = static_cast<float>(rect.top);
+		const float texRight  = static_cast<float>(rect.left + rect.width);
+		const float texBottom = static_cast<float>(rect.top + rect.height);
+
+		quad[0] = sf::Vertex(transform.transformPoint(0.f, 0.f), sprite.getColor(), {texLeft, texTop});
+		quad[1] = sf::Vertex(transform.transformPoint(size.x, 0.f), sprite.getColor(), {texRight, texTop});
+		quad[2] = sf::Vertex(transform.transformPoint(size.x, size.y), sprite.getColor(), {texRight, texBottom});
+		quad[3] = sf::Vertex(transform.transformPoint(0.f, size.y), sprite.getColor(), {texLeft, texBottom});
+
+		for (size_t i = 0; i < 4; ++i)
+			quad[i].position += renderOffset;
+	}
+
+	// Adds quadCount quads drawn with texture on layer and returns their vertices, four per quad, for the caller
+	// to fill in. They can only be written to until the next add.
+	sf::Vertex* appendQuads(const sf::Texture& texture, int layer, size_t quadCount)
+	{
+		Run run;
+		run.texture = &texture;
+		run.layer   = layer;
+		run.order   = static_cast<uint32_t>(runs.size());
+		run.first   = quadVertices.size();
+		run.count   = 4 * quadCount;
+		runs.push_back(run);
+
+		quadVertices.resize(quadVertices.size() + run.count);
+		return quadVertices.data() + run.first;
+	}
+
+	// Draws everything added since the last flush and clears the batch
+	void flush(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default)
+	{
+		TraceZone zone("SpriteBatch::flush");
+
+		std::sort(runs.begin(), runs.end(),
+				  [](const Run& a, const Run& b)
+				  {
+					  if (a.layer != b.layer)
+						  return a.layer < b.layer;
+					  if (a.texture != b.texture)
+						  return std::less<const sf::Texture*>()(a.texture, b.texture);
+					  return a.order < b.order;
+				  });
+
+		drawCalls = 0;
+
+		size_t i = 0;
+		while (i < runs.size())
+		{
+			const auto layer   = runs[i].layer;
+			const auto texture = runs[i].texture;
+
+			size_t end = i + 1;
+			while (end < runs.size() && runs[end].layer == layer && runs[end].texture == texture)
+				++end;
+
+			states.texture = texture;
+
+			// A run that has its texture and layer to itself is drawn without copying it first
+			if (end == i + 1)
+				target.draw(quadVertices.data() + runs[i].first, runs[i].count, sf::Quads, states);
+			else
+			{
+				vertices.clear();
+				for (; i < end; ++i)
+					vertices.insert(vertices.end(), quadVertices.begin() + runs[i].first,
+									quadVertices.begin() + runs[i].first + runs[i].count);
+
+				target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+			}
+
+			i = end;
+			++drawCalls;
+		}
+
+		runs.clear();
+		quadVertices.clear();
+
+		if (Tracing::Get().isEnabled())
+			Tracing::Get().counter("SpriteBatch draw calls", (double)drawCalls);
+	}
+
+	// Drops everything added since the last flush without drawing it
+	void clear()
+	{
+		runs.clear();
+		quadVertices.clear();
+	}
+
+	size_t getSpriteCount() const { return quadVertices.size() / 4; }
+	// Draw calls the last flush took
+	size_t getDrawCalls() const { return drawCalls; }
+
+private:
+	// Quads added together, their vertices are quadVertices[first, first + count)
+	struct Run
+	{
+		const sf::Texture* texture = nullptr;
+		int layer                  = 0;
+		uint32_t order             = 0;
+		size_t first               = 0;
+		size_t count               = 0;
+	};
+
+	std::vector<Run> runs;
+	std::vector<sf::Vertex> quadVertices;
+	// Runs sharing a texture and layer are copied together here to be drawn at once
+	std::vector<sf::Vertex> vertices;
+
+	size_t drawCalls = 0;
+};
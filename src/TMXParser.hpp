@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "Tracing.hpp"
 #include "XMLParser.hpp"
 
 struct TMXObjectProperty
@@ -87,6 +88,8 @@ public:
 
 	bool parse(const std::string& path, bool print = false)
 	{
+		TraceZone zone("TMXParser::parse");
+
 		if (print)
 			std::cout << "Building TMX objects from " << path << " ..." << std::endl;
 
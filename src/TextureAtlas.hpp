@@ -0,0 +1,151 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// Packs images into as few textures (pages) as possible, so things using different images can still be drawn
+// in one batch. Add images, call build(), then look up where each one ended up with getRegion().
+class TextureAtlas
+{
+public:
+	struct Region
+	{
+		const sf::Texture* texture = nullptr;
+		sf::IntRect rect;
+
+		sf::Vector2i getOffset() const { return {rect.left, rect.top}; }
+	};
+
+	TextureAtlas()  = default;
+	~TextureAtlas() = default;
+
+	bool addImage(const std::string& name, const std::string& path)
+	{
+		sf::Image image;
+		if (!image.loadFromFile(path))
+			return false;
+
+		addImage(name, image);
+		return true;
+	}
+	void addImage(const std::string& name, const sf::Image& image) { pending.push_back({name, image}); }
+
+	// Packs everything added so far into pages of at most maxPageSize x maxPageSize pixels. Images are
+	// separated by padding transparent pixels so they don't bleed into each other.
+	bool build(unsigned int maxPageSize = 2048, unsigned int padding = 1)
+	{
+		const unsigned int pageSize = std::min(maxPageSize, sf::Texture::getMaximumSize());
+
+		regions.clear();
+		pages.clear();
+
+		// Shelf packing, tallest images first so shelves waste less space
+		std::vector<size_t> order(pending.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+						 { return pending[a].image.getSize().y > pending[b].image.getSize().y; });
+
+		std::vector<std::vector<std::pair<size_t, sf::Vector2u>>> placements(1);
+		std::vector<sf::Vector2u> pageUsedSizes(1, sf::Vector2u(0, 0));
+
+		sf::Vector2u cursor(0, 0);
+		unsigned int shelfHeight = 0;
+
+		for (const auto i : order)
+		{
+			const auto size = pending[i].image.getSize();
+			if (size.x > pageSize || size.y > pageSize)
+			{
+				std::cerr << "Image " << pending[i].name << " doesn't fit into a " << pageSize << "px atlas page"
+						  << std::endl;
+				return false;
+			}
+
+			// Next shelf
+			if (cursor.x + size.x > pageSize)
+			{
+				cursor      = sf::Vector2u(0, cursor.y + shelfHeight + padding);
+				shelfHeight = 0;
+			}
+			// Next page
+			if (cursor.y + size.y > pageSize)
+			{
+				placements.emplace_back();
+				pageUsedSizes.emplace_back(0, 0);
+				cursor      = sf::Vector2u(0, 0);
+				shelfHeight = 0;
+			}
+
+			placements.back().push_back({i, cursor});
+
+			auto& used = pageUsedSizes.back();
+			used.x     = std::max(used.x, cursor.x + size.x);
+			used.y     = std::max(used.y, cursor.y + size.y);
+
+			cursor.x += size.x + padding;
+			shelfHeight = std::max(shelfHeight, size.y);
+		}
+
+		for (size_t page = 0; page < placements.size(); ++page)
+		{
+			if (placements[page].empty())
+				continue;
+
+			sf::Image pageImage;
+			pageImage.create(pageUsedSizes[page].x, pageUsedSizes[page].y, sf::Color::Transparent);
+
+			for (const auto& placement : placements[page])
+				pageImage.copy(pending[placement.first].image, placement.second.x, placement.second.y);
+
+			auto texture = std::make_unique<sf::Texture>();
+			if (!texture->loadFromImage(pageImage))
+				return false;
+
+			for (const auto& placement : placements[page])
+			{
+				const auto& entry = pending[placement.first];
+				regions[entry.name] =
+					Region{texture.get(), sf::IntRect((int)placement.second.x, (int)placement.second.y,
+													  (int)entry.image.getSize().x, (int)entry.image.getSize().y)};
+			}
+
+			pages.push_back(std::move(texture));
+		}
+
+		pending.clear();
+		return true;
+	}
+
+	// Region of the image added as name, or a region with an empty texture if there is no such image
+	const Region& getRegion(const std::string& name) const
+	{
+		static const sf::Texture emptyTexture;
+		static const Region emptyRegion{&emptyTexture, sf::IntRect()};
+
+		auto it = regions.find(name);
+		return it != regions.end() ? it->second : emptyRegion;
+	}
+	bool hasRegion(const std::string& name) const { return regions.count(name) != 0; }
+
+	size_t getPageCount() const { return pages.size(); }
+	const sf::Texture& getPage(size_t index) const { return *pages[index]; }
+
+private:
+	struct PendingImage
+	{
+		std::string name;
+		sf::Image image;
+	};
+
+	std::vector<PendingImage> pending;
+
+	// Pages are kept behind pointers so regions can point at them
+	std::vector<std::unique_ptr<sf::Texture>> pages;
+	std::map<std::string, Region, std::less<>> regions;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <utility>
+#include <vector>
+
+#include "ChunkMap.hpp"
+#include "JobSystem.hpp"
+#include "StaticTile.hpp"
+#include "Tracing.hpp"
+
+// Draws a static tile layer. Every chunk of the layer is baked into a single vertex array once, so drawing
+// it takes one draw call per chunk on screen instead of one per tile.
+class TileLayerRenderer
+{
+public:
+	TileLayerRenderer()  = default;
+	~TileLayerRenderer() = default;
+
+	// Bakes layer, has to be called again if the layer or the tileset change. tilesetRegion is where the
+	// tileset is in the texture when it's packed into an atlas, empty means the whole texture.
+	void create(const ChunkMap<StaticTile>& layer, const sf::Texture& tileset,
+				const sf::IntRect& tilesetRegion = sf::IntRect())
+	{
+		this->tileset = &tileset;
+		this->tilesetRegion =
+			tilesetRegion.width > 0 ? tilesetRegion
+									: sf::IntRect(0, 0, (int)tileset.getSize().x, (int)tileset.getSize().y);
+
+		chunks = ChunkMap<sf::VertexArray>(layer.getChunkSize());
+		if (layer.isBounded())
+			chunks.setBounds(layer.getBoundsMin(), layer.getBoundsMin() + layer.getBoundsSize() - sf::Vector2i(1, 1));
+
+		// Chunks are baked on all cores, then inserted in the order they were found
+		std::vector<std::pair<sf::Vector2i, const ChunkMap<StaticTile>::Chunk*>> layerChunks;
+		layer.forEachChunk([&layerChunks](const sf::Vector2i& index, const ChunkMap<StaticTile>::Chunk& chunk)
+						   { layerChunks.emplace_back(index, &chunk); });
+
+		std::vector<sf::VertexArray> baked(layerChunks.size(), sf::VertexArray(sf::Quads));
+		JobSystem::Get().parallelFor(layerChunks.size(), 16,
+									 [this, &layerChunks, &baked](size_t begin, size_t end)
+									 {
+										 for (size_t i = begin; i < end; ++i)
+										 {
+											 for (const auto& tile : *layerChunks[i].second)
+												 _addTile(baked[i], *tile);
+										 }
+									 });
+
+		for (size_t i = 0; i < layerChunks.size(); ++i)
+			chunks.insertNewValue(layerChunks[i].first, std::move(baked[i]));
+	}
+
+	// Draws chunks overlapping viewRect
+	void draw(sf::RenderTarget& target, const sf::FloatRect& viewRect) const
+	{
+		if (!tileset)
+			return;
+
+		TraceZone zone("TileLayerRenderer::draw");
+
+		chunks.forEachInRect(viewRect, [&target, this](const sf::VertexArray& vertices)
+							 { target.draw(vertices, sf::RenderStates(tileset)); });
+	}
+
+	size_t getChunkCount() const
+	{
+		size_t count = 0;
+		chunks.forEachChunk([&count](const sf::Vector2i&, const ChunkMap<sf::VertexArray>::Chunk&) { ++count; });
+		return count;
+	}
+
+private:
+	ChunkMap<sf::VertexArray> chunks;
+	const sf::Texture* tileset = nullptr;
+	sf::IntRect tilesetRegion;
+
+	void _addTile(sf::VertexArray& outVertices, const StaticTile& tile) const
+	{
+		const auto pos  = tile.getPosition();
+		const auto size = tile.getSize();
+
+		// Tiles are laid out left to right, top to bottom in the tileset
+		const auto tilesPerRow = (uint32_t)tilesetRegion.width / (uint32_t)size.x;
+		if (tilesPerRow == 0)
+			return;
+
+		const auto texPos      = sf::Vector2f(tilesetRegion.left + tile.getTileId() % tilesPerRow * size.x,
+											  tilesetRegion.top + tile.getTileId() / tilesPerRow * size.y);
+
+		outVertices.append(sf::Vertex(pos, texPos));
+		outVertices.append(sf::Vertex(sf::Vector2f(pos.x + size.x, pos.y), sf::Vector2f(texPos.x + size.x, texPos.y)));
+		outVertices.append(sf::Vertex(pos + size, texPos + size));
+		outVertices.append(sf::Vertex(sf::Vector2f(pos.x, pos.y + size.y), sf::Vector2f(texPos.x, texPos.y + size.y)));
+	}
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.hpp"
+
+// Writes trace events in the Chrome trace_event JSON format (open with chrome://tracing or Perfetto).
+// Every thread emitting events gets its own lock free buffer, a background thread empties them into the
+// file. While tracing is off, emitting an event is a single relaxed atomic load.
+class Tracing
+{
+public:
+	static Tracing& Get()
+	{
+		static Tracing INSTANCE;
+		return INSTANCE;
+	}
+	Tracing(Tracing&&)                 = delete;
+	Tracing(const Tracing&)            = delete;
+	Tracing& operator=(Tracing&&)      = delete;
+	Tracing& operator=(const Tracing&) = delete;
+
+	bool start(const std::string& path)
+	{
+		if (isEnabled())
+			return false;
+
+		file.open(path);
+		if (!file)
+			return false;
+
+		file << "{\"traceEvents\":[\n";
+		firstEvent = true;
+
+		_discardEvents();
+		droppedEvents = 0;
+
+		running = true;
+		writer  = std::thread(&Tracing::_writerLoop, this);
+
+		enabled.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Writes whatever is left and closes the file
+	void stop()
+	{
+		if (!isEnabled())
+			return;
+
+		enabled.store(false, std::memory_order_relaxed);
+
+		running = false;
+		writer.join();
+
+		_writeEvents();
+		file << "\n],\"otherData\":{\"droppedEvents\":" << droppedEvents.load() << "}}\n";
+		file.close();
+	}
+
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// name has to outlive the tracing session, string literals are best
+	void begin(const char* name) { _emit(name, 'B', 0.0); }
+	void end(const char* name) { _emit(name, 'E', 0.0); }
+	void counter(const char* name, double value) { _emit(name, 'C', value); }
+
+private:
+	struct Event
+	{
+		const char* name = nullptr;
+		char phase       = 'B';
+		int64_t time     = 0;
+		double value     = 0.0;
+	};
+
+	struct ThreadBuffer
+	{
+		uint32_t threadId = 0;
+		RingBuffer<Event, 65536> events;
+	};
+
+	std::atomic<bool> enabled{false};
+	std::atomic<bool> running{false};
+	std::atomic<uint64_t> droppedEvents{0};
+
+	std::thread writer;
+	std::ofstream file;
+	bool firstEvent = true;
+
+	std::mutex buffersMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	Tracing() = default;
+	~Tracing() { stop(); }
+
+	void _emit(const char* name, char phase, double value)
+	{
+		if (!isEnabled())
+			return;
+
+		const auto time =
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+		if (!_getThreadBuffer().events.push({name, phase, time, value}))
+			++droppedEvents;
+	}
+
+	ThreadBuffer& _getThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		if (!buffer)
+		{
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			buffers.push_back(std::make_unique<ThreadBuffer>());
+			buffer           = buffers.back().get();
+			buffer->threadId = static_cast<uint32_t>(buffers.size());
+		}
+		return *buffer;
+	}
+
+	void _writerLoop()
+	{
+		while (running)
+		{
+			_writeEvents();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	// A thread that checked isEnabled() just before the last stop() can still have pushed an event after the
+	// final _writeEvents(), it belongs to no session
+	void _discardEvents()
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+
+		Event event;
+		for (auto& buffer : buffers)
+		{
+			while (buffer->events.pop(event))
+			{
+			}
+		}
+	}
+
+	void _writeEvents()
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+
+		Event event;
+		for (auto& buffer : buffers)
+		{
+			while (buffer->events.pop(event))
+			{
+				file << (firstEvent ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+					 << "\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.time;
+				if (event.phase == 'C')
+					file << ",\"args\":{\"value\":" << event.value << '}';
+				file << '}';
+
+				firstEvent = false;
+			}
+		}
+	}
+};
+
+// Emits a begin event when constructed and the matching end event when destroyed
+class TraceZone
+{
+public:
+	explicit TraceZone(const char* name) : name(Tracing::Get().isEnabled() ? name : nullptr)
+	{
+		if (this->name)
+			Tracing::Get().begin(name);
+	}
+	~TraceZone()
+	{
+		if (name)
+			Tracing::Get().end(name);
+	}
+
+	TraceZone(const TraceZone&)            = delete;
+	TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+	const char* name;
+};
@@ -6,8 +6,11 @@
 #include <iostream>
 #include <sstream>
 #include <stack>
+#include <utility>
 #include <vector>
 
+#include "Tracing.hpp"
+
 struct XMLAttribute
 {
 	std::string name  = "";
@@ -31,6 +34,8 @@ public:
 
 	bool parseFile(const std::string& filename)
 	{
+		TraceZone zone("XMLParser::parseFile");
+
 		std::ifstream file(filename);
 		if (!file.is_open())
 		{
@@ -62,7 +67,7 @@ public:
 		return true;
 	}
 
-	XMLElement getRoot() const { return root; }
+	const XMLElement& getRoot() const { return root; }
 
 	void printParsedData() { print(root, ""); }
 
@@ -91,17 +96,13 @@ private:
 
 	void handlePopping()
 	{
-		auto child = stack.top();
+		// Moved, not copied, copying the parent every time made parsing quadratic in its child count
+		auto child = std::move(stack.top());
 		stack.pop();
 		if (!stack.empty())
-		{
-			auto parent = stack.top();
-			stack.pop();
-			parent.children.push_back(child);
-			stack.push(parent);
-		}
+			stack.top().children.push_back(std::move(child));
 		else
-			root = child;
+			root = std::move(child);
 	}
 
 	bool signedLessThanUnsigned(int sig, uint32_t unsig)
@@ -178,12 +179,7 @@ private:
 							stack.push(newElement);
 						}
 						else
-						{
-							auto element = stack.top();
-							stack.pop();
-							element.attributes.push_back(createNewAttribute(word));
-							stack.push(element);
-						}
+							stack.top().attributes.push_back(createNewAttribute(word));
 
 						if (shouldPopNext)
 						{
@@ -210,12 +206,7 @@ private:
 		}
 
 		if (firstChar != i && !stack.empty())
-		{
-			auto element = stack.top();
-			stack.pop();
-			element.attributes.push_back(createNewAttribute(line));
-			stack.push(element);
-		}
+			stack.top().attributes.push_back(createNewAttribute(line));
 
 		return true;
 	}
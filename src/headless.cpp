@@ -0,0 +1,263 @@
+#include <SFML/System.hpp>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "AllocationHooks.hpp"
+#include "GlobalDefines.hpp"
+#include "InputSource.hpp"
+#include "Inventory.hpp"
+#include "JobSystem.hpp"
+#include "Level.hpp"
+#include "Player.hpp"
+#include "Profiler.hpp"
+#include "Simulation.hpp"
+#include "Tracing.hpp"
+
+// Runs the simulation without a window as fast as it can and reports how many ticks per second it managed.
+// Usage: platformerHeadless [ticks] [--level path] [--grid] [--replay file] [--record file] [--trace file]
+//                           [--alloc-budget allocations] [--enemies count] [--threads count]
+// Replays run for as many ticks as were recorded unless ticks is given. --alloc-budget fails the run when a tick
+// after the first second allocates more than that, it needs a build with PLATFORMER_TRACK_ALLOCATIONS, and runs
+// everything on the main thread since allocations are only counted there. --enemies drops that many extra enemies
+// evenly across the top of the level. --threads sets the number of worker threads, 0 runs everything on the main
+// thread, the result is the same either way.
+
+// Keys as indexed in Controls
+enum ScriptedKey : uint32_t
+{
+	KEY_LEFT  = 1 << 2,
+	KEY_RIGHT = 1 << 3,
+	KEY_JUMP  = 1 << 4,
+	KEY_RUN   = 1 << 5,
+};
+
+// Same input every run so results can be compared, runs back and forth and jumps every half a second
+class ScriptedInputSource : public InputSource
+{
+public:
+	InputFrame nextFrame() override
+	{
+		uint32_t held = KEY_RUN;
+
+		held |= (tick / (4 * D_TICK_RATE)) % 2 == 0 ? KEY_RIGHT : KEY_LEFT;
+		if (tick % (D_TICK_RATE / 2) < D_TICK_RATE / 4)
+			held |= KEY_JUMP;
+
+		const auto toRet = InputFrame::fromHeld(held, previousHeld);
+		previousHeld     = held;
+		++tick;
+		return toRet;
+	}
+
+private:
+	uint64_t tick         = 0;
+	uint32_t previousHeld = 0;
+};
+
+namespace
+{
+void printUsage()
+{
+	std::cout << "Usage: platformerHeadless [ticks] [options]\n"
+			  << "  ticks                       ticks to run (default 100000, or as many as were recorded)\n"
+			  << "  --level path                level to load (default leveldata/testmap1.tmx)\n"
+			  << "  --grid                      collide against the tile grid instead of merged collision tiles\n"
+			  << "  --replay file               play back recorded input instead of the scripted one\n"
+			  << "  --record file               record the input to file\n"
+			  << "  --trace file                write a trace to file\n"
+			  << "  --alloc-budget allocations  fail when a tick after the first second allocates more\n"
+			  << "  --enemies count             extra enemies dropped across the top of the level (default 0)\n"
+			  << "  --threads count             worker threads, 0 runs everything on the main thread" << std::endl;
+}
+
+// False unless the whole of text is a number that fits in T
+template <typename T>
+bool parseNumber(const char* text, T& outValue)
+{
+	const char* end   = text + std::strlen(text);
+	const auto result = std::from_chars(text, end, outValue);
+	return result.ec == std::errc() && result.ptr == end && result.ptr != text;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+	uint64_t tickCount    = 0;
+	std::string levelPath = "leveldata/testmap1.tmx";
+	std::string replayPath;
+	std::string recordPath;
+	std::string tracePath;
+	bool gridCollision       = false;
+	int64_t allocationBudget = -1;
+	size_t enemyCount        = 0;
+	unsigned workerCount     = JobSystem::getDefaultWorkerCount();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		bool valid          = true;
+
+		if (std::strcmp(argv[i], "--level") == 0 && hasValue)
+			levelPath = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+			replayPath = argv[++i];
+		else if (std::strcmp(argv[i], "--record") == 0 && hasValue)
+			recordPath = argv[++i];
+		else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+			tracePath = argv[++i];
+		else if (std::strcmp(argv[i], "--alloc-budget") == 0 && hasValue)
+			valid = parseNumber(argv[++i], allocationBudget);
+		else if (std::strcmp(argv[i], "--enemies") == 0 && hasValue)
+			valid = parseNumber(argv[++i], enemyCount);
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+			valid = parseNumber(argv[++i], workerCount);
+		else if (std::strcmp(argv[i], "--grid") == 0)
+			gridCollision = true;
+		else if (argv[i][0] != '-')
+			valid = parseNumber(argv[i], tickCount);
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (allocationBudget >= 0 && !AllocationTracker::ENABLED)
+	{
+		std::cerr << "--alloc-budget needs a build with PLATFORMER_TRACK_ALLOCATIONS" << std::endl;
+		return 1;
+	}
+
+	// Allocations are counted per thread, jobs run on workers would allocate unnoticed
+	if (allocationBudget >= 0)
+		workerCount = 0;
+
+	JobSystem::Get().start(workerCount);
+
+	if (!tracePath.empty() && !Tracing::Get().start(tracePath))
+		std::cerr << "Error opening trace file " << tracePath << std::endl;
+
+	std::unique_ptr<InputSource> input = std::make_unique<ScriptedInputSource>();
+	if (!replayPath.empty())
+	{
+		InputLog log;
+		if (!log.load(replayPath))
+		{
+			std::cerr << "Error loading input replay " << replayPath << std::endl;
+			return 1;
+		}
+
+		if (tickCount == 0)
+			tickCount = log.getTickCount();
+		input = std::make_unique<ReplayInputSource>(std::move(log));
+	}
+	if (tickCount == 0)
+		tickCount = 100000;
+
+	RecordingInputSource* recorder = nullptr;
+	if (!recordPath.empty())
+	{
+		auto recording = std::make_unique<RecordingInputSource>(std::move(input));
+		recorder       = recording.get();
+		input          = std::move(recording);
+	}
+
+	// No textures, those would need a graphics context
+	Level level{AnimatedSprite()};
+	level.setMergeCollisionTiles(true);
+	level.create(levelPath, false);
+	level.accessCamera().setView(sf::View(sf::FloatRect(0.f, 0.f, 256.f, 192.f)));
+
+	level.Enemies.spawnAcross(level.SolidTiles, enemyCount);
+
+	Player player(sf::Vector2f(32, 128), Controls());
+
+	Inventory inventory;
+	inventory.addCollectBox(player.getCollectBox());
+
+	Simulation simulation(level, player, inventory);
+	simulation.setGridCollision(gridCollision);
+
+	// Every tick is a profiler frame so allocations can be blamed on a phase, no history is kept
+	auto& profiler = Profiler::Get();
+	profiler.setEnabled(false);
+
+	// The first second is spent filling buffers that get reused afterwards
+	const uint64_t warmUpTicks = D_TICK_RATE;
+
+	uint64_t steadyAllocations = 0;
+	Profiler::FrameSample worstTick;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t tick = 0; tick < tickCount; ++tick)
+	{
+		simulation.tick(D_TICK_DURATION, input->nextFrame());
+
+		if (AllocationTracker::ENABLED)
+		{
+			profiler.endFrame();
+
+			const auto& sample = profiler.getLastFrame();
+			if (tick >= warmUpTicks)
+			{
+				steadyAllocations += sample.allocations;
+				if (sample.allocations > worstTick.allocations)
+					worstTick = sample;
+			}
+		}
+	}
+
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Level:            " << levelPath << (gridCollision ? " (grid collision)" : "") << std::endl;
+	std::cout << "Ticks:            " << simulation.getTickCount() << " (" << simulation.getTickCount() / D_TICK_RATE
+			  << " s of game time)" << std::endl;
+	std::cout << "Wall time:        " << elapsed << " s" << std::endl;
+	std::cout << "Worker threads:   " << JobSystem::Get().getWorkerCount() << std::endl;
+	std::cout << "Ticks per second: " << (elapsed > 0.0 ? (double)simulation.getTickCount() / elapsed : 0.0)
+			  << std::endl;
+	std::cout << "Final position:   " << player.getPosition().x << ", " << player.getPosition().y << std::endl;
+	std::cout << "Coins collected:  " << inventory.getInventoryState().coins << std::endl;
+	std::cout << "Enemies left:     " << level.Enemies.size() << std::endl;
+
+	bool overBudget = false;
+	if (AllocationTracker::ENABLED)
+	{
+		std::cout << "Allocations:      " << steadyAllocations << " after warm up, at most " << worstTick.allocations
+				  << " in one tick" << std::endl;
+
+		if (worstTick.allocations > 0)
+		{
+			std::cout << "Worst tick:       " << worstTick.frame << " (" << worstTick.allocatedBytes << " B)";
+			for (size_t phase = 0; phase < Profiler::PHASE_COUNT; ++phase)
+			{
+				if (worstTick.phaseAllocations[phase] > 0)
+					std::cout << ' ' << Profiler::getPhaseName(phase) << ' ' << worstTick.phaseAllocations[phase];
+			}
+			std::cout << std::endl;
+		}
+
+		overBudget = allocationBudget >= 0 && (int64_t)worstTick.allocations > allocationBudget;
+		if (overBudget)
+			std::cerr << "Allocation budget of " << allocationBudget << " per tick exceeded" << std::endl;
+	}
+
+	Tracing::Get().stop();
+
+	if (recorder && !recorder->getLog().save(recordPath))
+	{
+		std::cerr << "Error saving input recording " << recordPath << std::endl;
+		return 1;
+	}
+
+	return overBudget ? 1 : 0;
+}
@@ -1,5 +1,8 @@
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
 #include <iomanip>
 #include <iostream>
 #include <locale>
@@ -7,23 +10,29 @@
 #include <valarray>
 #include <vector>
 
+#include "AllocationHooks.hpp"
 #include "BitmapFont.hpp"
 #include "Camera.hpp"
 #include "CollisionAlgorithms.hpp"
 #include "CollisionBody.hpp"
+#include "InputSource.hpp"
 #include "Inventory.hpp"
+#include "JobSystem.hpp"
 #include "Level.hpp"
 #include "Player.hpp"
+#include "Profiler.hpp"
+#include "ProfilerOverlay.hpp"
+#include "Simulation.hpp"
+#include "SpriteBatch.hpp"
 #include "TMXParser.hpp"
+#include "TextureAtlas.hpp"
+#include "TileLayerRenderer.hpp"
+#include "Tracing.hpp"
 #include "Vector2Functions.hpp"
 
-void handleSpriteInitPlayer(Player& outPlayer, sf::Texture& outTex)
+void handleSpriteInitPlayer(Player& outPlayer, const TextureAtlas::Region& region)
 {
-	if (!outTex.loadFromFile("assets/graphics/player_1.png"))
-	{
-		std::cerr << "Error loading player sprite texture" << std::endl;
-	}
-	outPlayer.setSpriteTexture(outTex);
+	outPlayer.setSpriteTexture(*region.texture, region.getOffset());
 	outPlayer.setSpriteTextureRect({0, 0, 16, 32});
 	outPlayer.setSpriteOrigin({8.f, 16.f});
 	outPlayer.setSpriteOffset({0.f, -9.f});
@@ -49,24 +58,19 @@ void handleSpriteInitPlayer(Player& outPlayer, sf::Texture& outTex)
 	pushAnim.addKeyToKeyFrameTimeline(AnimatedSprite::KeyType::RECT_X, 0, 112.f);
 	pushAnim.addKeyToKeyFrameTimeline(AnimatedSprite::KeyType::RECT_X, 400000, 128.f);
 
-	outPlayer.addAnimation("Stand", standAnim);
-	outPlayer.addAnimation("Run", runAnim);
-	outPlayer.addAnimation("Jump", jumpAnim);
-	outPlayer.addAnimation("Fall", fallAnim);
-	outPlayer.addAnimation("Turn", turnAnim);
-	outPlayer.addAnimation("Push", pushAnim);
+	outPlayer.addAnimation(Player::Animation::STAND, standAnim);
+	outPlayer.addAnimation(Player::Animation::RUN, runAnim);
+	outPlayer.addAnimation(Player::Animation::JUMP, jumpAnim);
+	outPlayer.addAnimation(Player::Animation::FALL, fallAnim);
+	outPlayer.addAnimation(Player::Animation::TURN, turnAnim);
+	outPlayer.addAnimation(Player::Animation::PUSH, pushAnim);
 }
 
-AnimatedSprite createCoinSprite(sf::Texture& coinTexture)
+AnimatedSprite createCoinSprite(const TextureAtlas::Region& region)
 {
 	AnimatedSprite toRet;
 
-	if (!coinTexture.loadFromFile("assets/graphics/items_1.png"))
-	{
-		std::cerr << "Error loading coin sprite texture" << std::endl;
-	}
-
-	toRet.setTexture(coinTexture);
+	toRet.setTexture(*region.texture, region.getOffset());
 	toRet.setTextureRect({0, 0, 16, 16});
 
 	KeyFrameAnimator<AnimatedSprite::KeyType> anim(500000);
@@ -80,10 +84,34 @@ AnimatedSprite createCoinSprite(sf::Texture& coinTexture)
 	return toRet;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --record <file> saves the input of this session, --replay <file> plays a saved one back,
+	// --trace <file> writes a Chrome trace of the session, --threads <count> sets the number of worker threads
+	std::string recordPath;
+	std::string replayPath;
+	std::string tracePath;
+	unsigned workerCount = JobSystem::getDefaultWorkerCount();
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--record") == 0)
+			recordPath = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0)
+			replayPath = argv[++i];
+		else if (std::strcmp(argv[i], "--trace") == 0)
+			tracePath = argv[++i];
+		else if (std::strcmp(argv[i], "--threads") == 0)
+			workerCount = (unsigned)std::stoul(argv[++i]);
+	}
+
+	JobSystem::Get().start(workerCount);
+
+	if (!tracePath.empty() && !Tracing::Get().start(tracePath))
+		std::cerr << "Error opening trace file " << tracePath << std::endl;
+
 	auto window = sf::RenderWindow{{1024u, 768u}, "Platform Game", sf::Style::Default};
 	window.setFramerateLimit(144);
+	window.setKeyRepeatEnabled(false);
 
 	// Set the locale to support Unicode
 	std::wcout.imbue(std::locale(""));
@@ -92,140 +120,221 @@ int main()
 	if (!fontKubasta.create("assets/font/kubasta_regular_8.PNG", "assets/font/kubasta_regular_8.fnt"))
 		std::cerr << "Error loading kubasta regular 8 font as BitmapFont" << std::endl;
 
+	// Everything gets packed into one texture, so the whole frame can be drawn from it
+	TextureAtlas atlas;
+	if (!atlas.addImage("player", "assets/graphics/player_1.png"))
+		std::cerr << "Error loading player sprite texture" << std::endl;
+	if (!atlas.addImage("items", "assets/graphics/items_1.png"))
+		std::cerr << "Error loading coin sprite texture" << std::endl;
+	if (!atlas.addImage("enemies", "assets/graphics/enemy_1.png"))
+		std::cerr << "Error loading enemy sprite texture" << std::endl;
+	if (!atlas.addImage("tiles", "assets/graphics/tiles_1.png"))
+		std::cerr << "Failed loading tiles_1.png" << std::endl;
+	if (!atlas.addImage("font", "assets/font/kubasta_regular_8.PNG"))
+		std::cerr << "Error loading kubasta regular 8 font page" << std::endl;
+	if (!atlas.build())
+		std::cerr << "Error building texture atlas" << std::endl;
+
+	if (atlas.hasRegion("font"))
+		fontKubasta.setFontTexture(*atlas.getRegion("font").texture, atlas.getRegion("font").getOffset());
+
 	// Debug mode
 	bool debugMode = false;
 
 	// Test entities
 
-	sf::Texture coinTexture;
-	Level level(createCoinSprite(coinTexture));
+	Level level(createCoinSprite(atlas.getRegion("items")));
+	level.setMergeCollisionTiles(true);
+	level.Enemies.setAnimation(atlas.getRegion("enemies").getOffset(), {16, 16}, 7, 700000);
 	level.create("leveldata/testmap1.tmx", false);
 	level.accessCamera().setView(sf::View(sf::FloatRect(0.f, 0.f, 256.f, 192.f)));
 
-	sf::Texture levelTiles;
-	if (!levelTiles.loadFromFile("assets/graphics/tiles_1.png"))
-		std::cerr << "Failed loading tiles_1.png" << std::endl;
+	const auto& levelTiles = atlas.getRegion("tiles");
+
+	TileLayerRenderer backgroundRenderer;
+	TileLayerRenderer collisionRenderer;
+	TileLayerRenderer foregroundRenderer;
+	{
+		const auto& texture = *levelTiles.texture;
+
+		auto bakeBackground = [&]() { backgroundRenderer.create(level.Background, texture, levelTiles.rect); };
+		auto bakeCollision  = [&]() { collisionRenderer.create(level.Collision, texture, levelTiles.rect); };
+		auto bakeForeground = [&]() { foregroundRenderer.create(level.Foreground, texture, levelTiles.rect); };
+
+		// Each layer bakes its chunks in parallel too
+		JobSystem::TaskGroup layers;
+		layers.run(bakeBackground);
+		layers.run(bakeCollision);
+		layers.run(bakeForeground);
+	}
 
 	Controls p1Controls;
 
 	Player player(sf::Vector2f(32, 128), p1Controls);
 	player.accessCollider().setColor(sf::Color(255, 100, 100, 120));
 
-	sf::Texture playerTexture;
-	handleSpriteInitPlayer(player, playerTexture);
+	handleSpriteInitPlayer(player, atlas.getRegion("player"));
 
 	Inventory inventory;
 	inventory.addCollectBox(player.getCollectBox());
 
+	Simulation simulation(level, player, inventory);
+
+	// Input comes from window events, eventInput stays null when replaying
+	auto events                        = std::make_unique<EventInputSource>(player.accessControls());
+	EventInputSource* eventInput       = events.get();
+	std::unique_ptr<InputSource> input = std::move(events);
+	if (!replayPath.empty())
+	{
+		InputLog log;
+		if (log.load(replayPath))
+		{
+			input      = std::make_unique<ReplayInputSource>(std::move(log));
+			eventInput = nullptr;
+		}
+		else
+			std::cerr << "Error loading input replay " << replayPath << std::endl;
+	}
+
+	RecordingInputSource* recorder = nullptr;
+	if (!recordPath.empty())
+	{
+		auto recording = std::make_unique<RecordingInputSource>(std::move(input));
+		recorder       = recording.get();
+		input          = std::move(recording);
+	}
+
+	// Only input goes into a recording, so settings changing the simulation stay as they are while one is made
+	// or played back
+	const bool inputLogged = recorder || !eventInput;
+
 	//  ||--------------------------------------------------------------------------------||
 	//  ||                                    Main loop                                   ||
 	//  ||--------------------------------------------------------------------------------||
 
+	// Reused every frame when gathering collision bodies for the debug overlay
+	std::vector<StaticTile*> tileBuffer;
+
+	// Text is formatted into these and turned into vertices every frame, reusing their memory
+	std::wstring hudText;
+	std::wstring debugText;
+	sf::VertexArray textDrawable;
+	wchar_t textBuffer[128];
+
+	// Enemies are drawn straight from their arrays, not through the sprite batch
+	sf::VertexArray enemyVertices(sf::Quads);
+
+	SpriteBatch spriteBatch;
+	ProfilerOverlay profilerOverlay;
+
 	sf::Clock clock;
+	sf::Int64 accumulator = 0;
+
+	// Never restarted, input events and ticks are timed with it
+	sf::Clock inputClock;
 	while (window.isOpen())
 	{
-		for (auto event = sf::Event{}; window.pollEvent(event);)
+		// Input
 		{
-			if (event.type == sf::Event::Closed)
-				window.close();
+			ProfileZone zone(Profiler::INPUT);
 
-			// Handling debug mode toggles
-			if (event.type == sf::Event::KeyPressed && debugMode)
+			for (auto event = sf::Event{}; window.pollEvent(event);)
 			{
-				switch (event.key.scancode)
-				{
-					case sf::Keyboard::Scan::Numpad9:
-						window.setFramerateLimit(0);
-						break;
-
-					case sf::Keyboard::Scan::Numpad8:
-						window.setFramerateLimit(60);
-						break;
+				if (event.type == sf::Event::Closed)
+					window.close();
 
-					case sf::Keyboard::Scan::Numpad7:
-						window.setFramerateLimit(30);
-						break;
+				if (eventInput)
+					eventInput->handleEvent(event, inputClock.getElapsedTime().asMicroseconds());
 
-					case sf::Keyboard::Scan::Numpad5:
-						window.setFramerateLimit(144);
-						break;
-
-					default:
-						break;
+				// Handling debug mode toggles
+				if (event.type == sf::Event::KeyPressed && debugMode)
+				{
+					switch (event.key.scancode)
+					{
+						case sf::Keyboard::Scan::Numpad9:
+							window.setFramerateLimit(0);
+							break;
+
+						case sf::Keyboard::Scan::Numpad8:
+							window.setFramerateLimit(60);
+							break;
+
+						case sf::Keyboard::Scan::Numpad7:
+							window.setFramerateLimit(30);
+							break;
+
+						case sf::Keyboard::Scan::Numpad5:
+							window.setFramerateLimit(144);
+							break;
+
+						case sf::Keyboard::Scan::Numpad1:
+							if (inputLogged)
+								std::cout << "Collision can't be switched while recording or replaying" << std::endl;
+							else
+								simulation.setGridCollision(!simulation.getGridCollision());
+							break;
+
+						case sf::Keyboard::Scan::Numpad2:
+							if (Profiler::Get().dumpCsv("profile.csv"))
+								std::cout << "Profiler history saved to profile.csv" << std::endl;
+							else
+								std::cerr << "Error saving profile.csv" << std::endl;
+							break;
+
+						default:
+							break;
+					}
 				}
+				if (event.type == sf::Event::KeyPressed && event.key.scancode == sf::Keyboard::Scan::Numpad0)
+					debugMode = !debugMode;
 			}
-			if (event.type == sf::Event::KeyPressed && event.key.scancode == sf::Keyboard::Scan::Numpad0)
-				debugMode = !debugMode;
 		}
 
-		auto delta = clock.restart().asMicroseconds();
-		if (delta > 100000)
-			continue;
+		auto frameDelta = clock.restart().asMicroseconds();
+
+		// Long frames (window being dragged, breakpoints) only catch up on D_MAX_CATCH_UP_STEPS ticks
+		accumulator = std::min(accumulator + frameDelta, (sf::Int64)D_TICK_DURATION * D_MAX_CATCH_UP_STEPS);
 
 		// ||--------------------------------------------------------------------------------||
 		// ||                                     Process                                    ||
 		// ||--------------------------------------------------------------------------------||
 
-		if (!level.accessCamera().isInTransitionAnimation())
-			player.process(delta);
-
-		player.animate(delta);
+		const auto now = inputClock.getElapsedTime().asMicroseconds();
 
-		// Collision
+		int ticks = 0;
+		while (accumulator >= D_TICK_DURATION)
 		{
-			auto beforeMoveVec = player.getMoveVector();
-			auto resVec = CollisionAlgorithms::Get().AABBWithStaticBodiesCollisionCheck(level.Collision, player, {});
+			accumulator -= D_TICK_DURATION;
+			++ticks;
 
-			player.move(resVec);
+			// The last tick of the frame takes every event polled so far. When catching up, the earlier ticks end
+			// a tick apart before it and only take the events polled until then.
+			if (eventInput)
+				eventInput->advanceTo(now - (accumulator / D_TICK_DURATION) * D_TICK_DURATION);
 
-			player.resetOnEverything();
-
-			if (resVec.x * beforeMoveVec.x < 0.f)
-			{
-				player.setMoveVector({0.f, player.getMoveVector().y});
-
-				if (resVec.x > 0.f)
-					player.setOnLeftWall(true);
-				else
-					player.setOnRightWall(true);
-			}
-			if (resVec.y * beforeMoveVec.y < 0.f)
-			{
-				player.setMoveVector({player.getMoveVector().x, 0.f});
-
-				if (resVec.y < 0.f)
-					player.setOnFloor(true);
-				else
-					player.setOnCeil(true);
-			}
+			simulation.tick(D_TICK_DURATION, input->nextFrame());
 		}
 
-		// Coins
-		for (auto&& coin : level.Collectables)
+		if (input->ended())
 		{
-			coin.animate(delta);
+			std::cout << "Replay finished after " << simulation.getTickCount() << " ticks" << std::endl;
+			window.close();
 		}
-		inventory.checkIfCollectedAnything(level.Collectables);
 
-		// Camera
-		if (level.accessCamera().isInTransitionAnimation())
-		{
-			level.accessCamera().transitionAnimationTick(delta, player);
-		}
-		else
-		{
-			level.accessCamera().followEntity(player, player.accessCollider().getRectangleShape().getSize().x / 2.f,
-											  player.accessCollider().getRectangleShape().getSize().y / 2.f);
-		}
-		window.setView(level.accessCamera().getView());
+		// How far between the last two ticks this frame is
+		const float alpha = (float)accumulator / (float)D_TICK_DURATION;
 
-		auto hudText = L"GEMS: " + std::to_wstring(inventory.getInventoryState().coins);
+		const auto view = level.accessCamera().getInterpolatedView(alpha);
+		window.setView(view);
 
-		auto debugText =
-			L"delta: " + std::to_wstring(delta) + L"\nFPS: " + std::to_wstring(delta > 0 ? 1000000 / delta : 0);
+		if (std::swprintf(textBuffer, 128, L"GEMS: %u", (unsigned)inventory.getInventoryState().coins) > 0)
+			hudText.assign(textBuffer);
 
-		auto textPos = level.accessCamera().getView().getCenter() - (level.accessCamera().getView().getSize() / 2.f) +
-					   sf::Vector2f(2.f, -2.f);
+		if (std::swprintf(textBuffer, 128, L"delta: %lld\nFPS: %lld\nticks: %d", (long long)frameDelta,
+						  (long long)(frameDelta > 0 ? 1000000 / frameDelta : 0), ticks) > 0)
+			debugText.assign(textBuffer);
+
+		auto textPos = view.getCenter() - (view.getSize() / 2.f) + sf::Vector2f(2.f, -2.f);
 
 		// ||--------------------------------------------------------------------------------||
 		// ||                                     Render                                     ||
@@ -233,49 +342,35 @@ int main()
 
 		window.clear(debugMode ? sf::Color::Black : level.getBackgroundColor());
 
-		// Drawing tiles, backgrounds and collectables
-		// ugly placeholder code for testing
-		// TODO get rid of it
-		sf::Sprite tile(levelTiles);
-		{
-			auto set = level.Background.gatherFromChunks();
-			for (auto&& cb : set)
-			{
-				auto id     = cb->getTileId();
-				int texLeft = id % (uint32_t)(levelTiles.getSize().x / (uint32_t)cb->getSize().x) * cb->getSize().x;
-				int texTop  = id / (uint32_t)(levelTiles.getSize().x / (uint32_t)cb->getSize().x) * cb->getSize().y;
+		// Drawing tiles, backgrounds and collectables, only what the camera can see
+		const auto viewRect = sf::FloatRect(view.getCenter() - view.getSize() / 2.f, view.getSize());
 
-				tile.setTextureRect(sf::IntRect(texLeft, texTop, (int)cb->getSize().x, (int)cb->getSize().y));
-				tile.setPosition(cb->getPosition());
-				window.draw(tile);
-			}
+		{
+			ProfileZone zone(Profiler::TILES);
+			backgroundRenderer.draw(window, viewRect);
+			collisionRenderer.draw(window, viewRect);
 		}
 		{
-			auto set = level.Collision.gatherFromChunks();
-			for (auto&& cb : set)
-			{
-				auto id     = cb->getTileId();
-				int texLeft = id % (uint32_t)(levelTiles.getSize().x / (uint32_t)cb->getSize().x) * cb->getSize().x;
-				int texTop  = id / (uint32_t)(levelTiles.getSize().x / (uint32_t)cb->getSize().x) * cb->getSize().y;
+			ProfileZone zone(Profiler::SPRITES);
+			level.CoinSprites.appendQuads(spriteBatch, 0);
 
-				tile.setTextureRect(sf::IntRect(texLeft, texTop, (int)cb->getSize().x, (int)cb->getSize().y));
-				tile.setPosition(cb->getPosition());
-				window.draw(tile);
-			}
+			enemyVertices.clear();
+			level.Enemies.appendQuads(enemyVertices, viewRect, alpha);
+			if (atlas.hasRegion("enemies"))
+				window.draw(enemyVertices, atlas.getRegion("enemies").texture);
+
+			spriteBatch.add(player.getSprite(), 1, player.getInterpolatedPosition(alpha) - player.getPosition());
+			spriteBatch.flush(window);
 		}
 		{
-			for (auto&& coin : level.Collectables)
-			{
-				window.draw(coin.getSprite());
-			}
+			ProfileZone zone(Profiler::TILES);
+			foregroundRenderer.draw(window, viewRect);
 		}
 
-		window.draw(player.getSprite());
-
 		if (debugMode)
 		{
-			auto set = level.Collision.gatherFromChunks();
-			for (auto&& cb : set)
+			level.CollisionBodies.query(viewRect, tileBuffer);
+			for (auto* cb : tileBuffer)
 				window.draw(cb->getRectangleShape());
 
 			for(auto&& coin : level.Collectables)
@@ -284,13 +379,27 @@ int main()
 			window.draw(player.accessCollider().getRectangleShape());
 			window.draw(player.getCollectBox()->getRectangleShape());
 
-			window.draw(fontKubasta.getTextDrawable(debugText, textPos).first, &fontKubasta.getFontTexture());
+			fontKubasta.getTextDrawable(textDrawable, debugText, textPos);
+			window.draw(textDrawable, &fontKubasta.getFontTexture());
+
+			profilerOverlay.draw(window, fontKubasta,
+								 {viewRect.left + 2.f, viewRect.top + viewRect.height - 34.f, 128.f, 32.f});
 		}
 		else
 		{
-			window.draw(fontKubasta.getTextDrawable(hudText, textPos).first, &fontKubasta.getFontTexture());
+			ProfileZone zone(Profiler::HUD);
+			fontKubasta.getTextDrawable(textDrawable, hudText, textPos);
+			window.draw(textDrawable, &fontKubasta.getFontTexture());
 		}
 
 		window.display();
+
+		Profiler::Get().endFrame();
+		Profiler::Get().collect();
 	}
+
+	if (recorder && !recorder->getLog().save(recordPath))
+		std::cerr << "Error saving input recording " << recordPath << std::endl;
+
+	Tracing::Get().stop();
 }
\ No newline at end of file
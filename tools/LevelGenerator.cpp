@@ -0,0 +1,88 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "LevelGenerator.hpp"
+
+// Usage: platformerLevelGenerator output.tmx [--width tiles] [--height tiles] [--chunked] [--chunk-size WxH]
+//                                 [--solid density] [--coins density] [--camera-zones count] [--enemies count]
+//                                 [--seed seed]
+
+namespace
+{
+void printUsage()
+{
+	std::cout << "Usage: platformerLevelGenerator output.tmx [options]\n"
+			  << "  --width tiles         level width, up to 100000 (default 1024)\n"
+			  << "  --height tiles        level height, up to 10000 (default 64)\n"
+			  << "  --chunked             write layers as chunks (like an infinite Tiled map) instead of loose CSV\n"
+			  << "  --chunk-size WxH      chunk size in tiles (default 8x6)\n"
+			  << "  --solid density       chance of a platform in each platform slot, 0 to 1 (default 0.3)\n"
+			  << "  --coins density       chance of a coin above each solid tile, 0 to 1 (default 0.1)\n"
+			  << "  --camera-zones count  camera zones the level is split into (default 4)\n"
+			  << "  --enemies count       enemies spread over the ground (default 0)\n"
+			  << "  --seed seed           (default 1)" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+	LevelGeneration::Options options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--width") == 0 && hasValue)
+			options.width = std::stoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--height") == 0 && hasValue)
+			options.height = std::stoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--chunked") == 0)
+			options.chunked = true;
+		else if (std::strcmp(argv[i], "--chunk-size") == 0 && hasValue)
+		{
+			const std::string size = argv[++i];
+			const auto separator   = size.find('x');
+			if (separator == std::string::npos)
+			{
+				printUsage();
+				return 1;
+			}
+			options.chunkWidth  = std::stoi(size.substr(0, separator));
+			options.chunkHeight = std::stoi(size.substr(separator + 1));
+		}
+		else if (std::strcmp(argv[i], "--solid") == 0 && hasValue)
+			options.solidDensity = std::stof(argv[++i]);
+		else if (std::strcmp(argv[i], "--coins") == 0 && hasValue)
+			options.coinDensity = std::stof(argv[++i]);
+		else if (std::strcmp(argv[i], "--camera-zones") == 0 && hasValue)
+			options.cameraZones = std::stoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--enemies") == 0 && hasValue)
+			options.enemies = std::stoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+			options.seed = (uint32_t)std::stoul(argv[++i]);
+		else if (argv[i][0] != '-' && options.outputPath.empty())
+			options.outputPath = argv[i];
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (options.outputPath.empty() || options.chunkWidth <= 0 || options.chunkHeight <= 0)
+	{
+		printUsage();
+		return 1;
+	}
+
+	LevelGeneration::clampOptions(options);
+
+	LevelGeneration::LevelGenerator generator(options);
+	if (!generator.write())
+		return 1;
+
+	std::cout << "Wrote " << options.width << "x" << options.height << " tile level to " << options.outputPath
+			  << std::endl;
+	return 0;
+}
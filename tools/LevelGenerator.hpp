@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Writes big procedural levels in the TMX format TMXParser reads, for stress testing loading, ChunkMap,
+// collision and rendering. Every tile is a pure function of the seed and its position, so levels of any size
+// are streamed straight to the file and the same options always give the same level.
+namespace LevelGeneration
+{
+// Tile ids used by testmap1.tmx
+const int TILE_GROUND_TOP    = 3;
+const int TILE_GROUND        = 12;
+const int TILE_PLATFORM      = 9;
+const int TILE_COIN          = 255;
+const int TILES_BACKGROUND[] = {30, 31, 32, 52, 53, 54};
+
+// Horizontal run of tiles a platform can take up, platforms are placed in slots this wide
+const int PLATFORM_SLOT = 8;
+
+// Vertical distance between rows that can hold platforms, leaves room to jump between them
+const int PLATFORM_ROW_SPACING = 3;
+
+// Level size limits in tiles
+const int MAX_WIDTH  = 100000;
+const int MIN_HEIGHT = 4;
+const int MAX_HEIGHT = 10000;
+
+struct Options
+{
+	std::string outputPath;
+
+	int width  = 1024;
+	int height = 64;
+
+	bool chunked    = false;
+	int chunkWidth  = 8;
+	int chunkHeight = 6;
+
+	float solidDensity = 0.3f;
+	float coinDensity  = 0.1f;
+	int cameraZones    = 4;
+	int enemies        = 0;
+
+	uint32_t seed = 1;
+};
+
+enum Layer : uint32_t
+{
+	BACKGROUND = 1,
+	COLLISION  = 2,
+	FOREGROUND = 3,
+};
+
+inline uint32_t hash(uint32_t seed, uint32_t a, uint32_t b, uint32_t c)
+{
+	uint32_t h = seed * 0x9E3779B1u;
+	for (const auto value : {a, b, c})
+	{
+		h ^= value + 0x7F4A7C15u + (h << 6) + (h >> 2);
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+	}
+	return h;
+}
+
+// Uniform in [0, 1)
+inline float random01(uint32_t seed, uint32_t a, uint32_t b, uint32_t c)
+{
+	return (float)(hash(seed, a, b, c) >> 8) / (float)(1u << 24);
+}
+
+// value rounded up to a multiple of step, or down when that would be over max
+inline int roundToMultiple(int value, int step, int max)
+{
+	const int roundedUp = (value + step - 1) / step * step;
+	return roundedUp <= max ? roundedUp : max / step * step;
+}
+
+// Brings options within the limits above. TMXParser only splits loose CSV into whole chunks, anything left
+// over would be dropped, so the level size is made a multiple of the chunk size as well.
+inline void clampOptions(Options& options)
+{
+	options.chunkWidth   = std::clamp(options.chunkWidth, 1, MAX_WIDTH);
+	options.chunkHeight  = std::clamp(options.chunkHeight, 1, MAX_HEIGHT);
+	options.width        = roundToMultiple(std::clamp(options.width, 1, MAX_WIDTH), options.chunkWidth, MAX_WIDTH);
+	options.height       = roundToMultiple(std::clamp(options.height, MIN_HEIGHT, MAX_HEIGHT), options.chunkHeight,
+										   MAX_HEIGHT);
+	options.solidDensity = std::clamp(options.solidDensity, 0.f, 1.f);
+	options.coinDensity  = std::clamp(options.coinDensity, 0.f, 1.f);
+	options.cameraZones  = std::clamp(options.cameraZones, 0, options.width);
+	options.enemies      = std::clamp(options.enemies, 0, 1000000);
+}
+
+class LevelGenerator
+{
+public:
+	explicit LevelGenerator(const Options& options) : options(options) {}
+
+	// Surface of the ground in column x, smoothly wandering around the bottom quarter of the level
+	int getGroundTop(int x) const
+	{
+		const int step     = 16;
+		const int cell     = x / step;
+		const float weight = (float)(x % step) / (float)step;
+
+		const int range = std::max(options.height / 4, 1);
+		const float a   = random01(options.seed, 0, (uint32_t)cell, 0) * (float)range;
+		const float b   = random01(options.seed, 0, (uint32_t)cell + 1, 0) * (float)range;
+
+		return options.height - 2 - (int)(a + (b - a) * weight);
+	}
+
+	bool isSolid(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= options.width || y >= options.height)
+			return false;
+
+		if (y >= getGroundTop(x))
+			return true;
+
+		// Platforms, only on every few rows and never touching the ground or the top of the level
+		if (y < 2 || y % PLATFORM_ROW_SPACING != 0 || y >= getGroundTop(x) - 2)
+			return false;
+
+		const int slot = x / PLATFORM_SLOT;
+		if (random01(options.seed, 1, (uint32_t)slot, (uint32_t)y) >= options.solidDensity)
+			return false;
+
+		// Each platform covers a random part of its slot
+		const int start  = (int)(hash(options.seed, 2, (uint32_t)slot, (uint32_t)y) % (PLATFORM_SLOT / 2));
+		const int length = 2 + (int)(hash(options.seed, 3, (uint32_t)slot, (uint32_t)y) % (PLATFORM_SLOT / 2));
+		const int offset = x % PLATFORM_SLOT;
+
+		return offset >= start && offset < start + length;
+	}
+
+	int getTile(Layer layer, int x, int y) const
+	{
+		switch (layer)
+		{
+			case COLLISION:
+				if (isSolid(x, y))
+				{
+					if (y >= getGroundTop(x))
+						return y == getGroundTop(x) ? TILE_GROUND_TOP : TILE_GROUND;
+					return TILE_PLATFORM;
+				}
+
+				// Coins float just above something to stand on
+				if (isSolid(x, y + 1) && random01(options.seed, 4, (uint32_t)x, (uint32_t)y) < options.coinDensity)
+					return TILE_COIN;
+
+				return 0;
+
+			case BACKGROUND:
+				if (y < getGroundTop(x) && random01(options.seed, 5, (uint32_t)x, (uint32_t)y) < 0.02f)
+					return TILES_BACKGROUND[hash(options.seed, 6, (uint32_t)x, (uint32_t)y) % 6];
+				return 0;
+
+			case FOREGROUND:
+			default:
+				return 0;
+		}
+	}
+
+	bool write()
+	{
+		std::ofstream file(options.outputPath, std::ios::binary);
+		if (!file)
+		{
+			std::cerr << "Error opening " << options.outputPath << std::endl;
+			return false;
+		}
+
+		file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			 << "<map version=\"1.10\" tiledversion=\"1.10.2\" orientation=\"orthogonal\" renderorder=\"right-down\" "
+			 << "width=\"" << options.width << "\" height=\"" << options.height
+			 << "\" tilewidth=\"16\" tileheight=\"16\" infinite=\"" << (options.chunked ? 1 : 0)
+			 << "\" backgroundcolor=\"#55aaff\" nextlayerid=\"6\" nextobjectid=\""
+			 << options.cameraZones + options.enemies + 1
+			 << "\">\n"
+			 << " <editorsettings>\n"
+			 << "  <chunksize width=\"" << options.chunkWidth << "\" height=\"" << options.chunkHeight << "\"/>\n"
+			 << "  <export format=\"tmx\"/>\n"
+			 << " </editorsettings>\n"
+			 << " <tileset firstgid=\"1\" source=\"tiles_1.tsj\"/>\n";
+
+		_writeLayer(file, BACKGROUND, "Background");
+		_writeLayer(file, COLLISION, "Collision");
+		_writeLayer(file, FOREGROUND, "Foreground");
+		_writeCameraZones(file);
+		_writeEnemies(file);
+
+		file << "</map>\n";
+
+		if (!file)
+		{
+			std::cerr << "Error writing " << options.outputPath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+private:
+	const Options& options;
+
+	// Reused for every row so huge levels don't allocate a string per row
+	std::string row;
+
+	void _writeRow(std::ofstream& file, Layer layer, int y, int firstX, int width, bool lastRow)
+	{
+		row.clear();
+		for (int x = firstX; x < firstX + width; ++x)
+		{
+			char number[16];
+			const auto end = std::to_chars(number, number + sizeof(number), getTile(layer, x, y)).ptr;
+			row.append(number, end);
+			if (x + 1 < firstX + width || !lastRow)
+				row += ',';
+		}
+		row += '\n';
+		file.write(row.data(), (std::streamsize)row.size());
+	}
+
+	void _writeLayer(std::ofstream& file, Layer layer, const char* name)
+	{
+		file << " <layer id=\"" << (int)layer << "\" name=\"" << name << "\" width=\"" << options.width
+			 << "\" height=\"" << options.height << "\">\n"
+			 << "  <data encoding=\"csv\">\n";
+
+		if (options.chunked)
+		{
+			// Chunks are keyed by their first tile, the way Tiled writes infinite maps
+			for (int chunkY = 0; chunkY < options.height; chunkY += options.chunkHeight)
+			{
+				for (int chunkX = 0; chunkX < options.width; chunkX += options.chunkWidth)
+				{
+					file << "   <chunk x=\"" << chunkX << "\" y=\"" << chunkY << "\" width=\"" << options.chunkWidth
+						 << "\" height=\"" << options.chunkHeight << "\">\n";
+
+					for (int y = chunkY; y < chunkY + options.chunkHeight; ++y)
+						_writeRow(file, layer, y, chunkX, options.chunkWidth, y + 1 == chunkY + options.chunkHeight);
+
+					file << "</chunk>\n";
+				}
+			}
+		}
+		else
+		{
+			for (int y = 0; y < options.height; ++y)
+				_writeRow(file, layer, y, 0, options.width, y + 1 == options.height);
+		}
+
+		file << "</data>\n"
+			 << " </layer>\n";
+	}
+
+	// Splits the level into equally wide zones side by side, the camera transitions between neighbours and
+	// blocks the player at the ends of the level
+	void _writeCameraZones(std::ofstream& file)
+	{
+		if (options.cameraZones <= 0)
+			return;
+
+		file << " <objectgroup id=\"4\" name=\"CameraZones\">\n";
+
+		const int levelWidth  = options.width * 16;
+		const int levelHeight = options.height * 16;
+
+		for (int zone = 0; zone < options.cameraZones; ++zone)
+		{
+			const int left  = (int)((int64_t)levelWidth * zone / options.cameraZones);
+			const int right = (int)((int64_t)levelWidth * (zone + 1) / options.cameraZones);
+
+			file << "  <object id=\"" << zone + 1 << "\" type=\"CameraZone\" x=\"" << left << "\" y=\"0\" width=\""
+				 << right - left << "\" height=\"" << levelHeight << "\">\n"
+				 << "   <properties>\n"
+				 << "    <property name=\"Bottom\" type=\"int\" value=\"-2\"/>\n"
+				 << "    <property name=\"Left\" type=\"int\" value=\"" << (zone == 0 ? -2 : 1) << "\"/>\n"
+				 << "    <property name=\"Right\" type=\"int\" value=\""
+				 << (zone + 1 == options.cameraZones ? -2 : 1) << "\"/>\n"
+				 << "    <property name=\"Top\" type=\"int\" value=\"0\"/>\n"
+				 << "   </properties>\n"
+				 << "  </object>\n";
+		}
+
+		file << " </objectgroup>\n";
+	}
+
+	// Spreads enemies evenly over the level, each standing on the ground
+	void _writeEnemies(std::ofstream& file)
+	{
+		if (options.enemies <= 0)
+			return;
+
+		file << " <objectgroup id=\"5\" name=\"Enemies\">\n";
+
+		for (int enemy = 0; enemy < options.enemies; ++enemy)
+		{
+			const int x = (int)(((int64_t)options.width * 2 * enemy + options.width) / (2 * options.enemies));
+
+			file << "  <object id=\"" << options.cameraZones + enemy + 1 << "\" type=\"Enemy\" x=\"" << x * 16 + 8
+				 << "\" y=\"" << getGroundTop(x) * 16 << "\">\n"
+				 << "   <point/>\n"
+				 << "  </object>\n";
+		}
+
+		file << " </objectgroup>\n";
+	}
+};
+}  // namespace LevelGeneration